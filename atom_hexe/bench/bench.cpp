@@ -0,0 +1,438 @@
+#include "corpus.h"
+#include "extractor.h"
+#include "generator.h"
+#include "json_output.h"
+#include "mapped_file.h"
+#include "stats.h"
+#include "xml2json/xml2json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+using BenchClock = std::chrono::steady_clock;
+
+// Extraction builds the json of a method in place, which takes about 11 allocations per method on the default
+// corpus. Copying subtrees around again takes it to 40 or more, so going over this means something regressed
+constexpr double g_DefaultAllocationBudget = 16.0;
+
+// How long a stage took and how much it got through, only the fastest run of each stage is reported
+struct StageResult {
+  const char* name = "";
+  double seconds = 0.0;
+  size_t bytes = 0;
+  size_t compounds = 0;
+  uint64_t allocations = 0;
+};
+
+double SecondsSince(BenchClock::time_point a_Start) {
+  return std::chrono::duration<double>(BenchClock::now() - a_Start).count();
+}
+
+uint64_t AllocationsSince(uint64_t a_Start) {
+  return ThreadAllocations().count - a_Start;
+}
+
+void KeepFastest(StageResult& a_Best, const StageResult& a_Run) {
+  if (a_Best.seconds == 0.0 || a_Run.seconds < a_Best.seconds) {
+    a_Best = a_Run;
+  }
+}
+
+size_t PeakMemoryBytes() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters{};
+  return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return static_cast<size_t>(usage.ru_maxrss);
+#else
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// One run through every stage of the generator over the corpus. The stages that the generator doesn't use
+// anymore (the xml to json conversion and parsing that json again) are timed as well so there is something
+// to compare against when working on them
+class BenchRun {
+public:
+  BenchRun(const std::string& a_CorpusDir, const std::string& a_OutputDir) : m_CorpusDir(a_CorpusDir), m_OutputDir(a_OutputDir) {}
+
+  // Maps every file in the index and reads through all of it so that the later stages don't pay for page faults
+  StageResult Load() {
+    auto start = BenchClock::now();
+    auto result = StageResult{"load"};
+    auto allocations = ThreadAllocations().count;
+
+    m_Index.Open(JoinPath(m_CorpusDir, "index.xml"));
+    result.bytes += m_Index.Size();
+
+    // The index has to be read to know which files there are, that's part of loading as well
+    tinyxml2::XMLDocument xmlDoc{};
+    xmlDoc.ParseInPlace(m_Index.Data(), m_Index.Size());
+    m_Cache.index.clear();
+    ExtractIndex(xmlDoc, m_Cache.index);
+
+    m_Files = std::vector<MappedFile>(m_Cache.index.size());
+    for (auto i = size_t{0}; i < m_Files.size(); i++) {
+      m_Files[i].Open(JoinPath(m_CorpusDir, m_Cache.index[i].fileName));
+      m_Checksum += HashContents(m_Files[i].Data(), m_Files[i].Size());
+      result.bytes += m_Files[i].Size();
+    }
+
+    result.seconds = SecondsSince(start);
+    result.compounds = m_Files.size();
+    result.allocations = AllocationsSince(allocations);
+    return result;
+  }
+
+  // Scans index.xml on every thread the way the generator does, it's mapped again since loading parsed it in place
+  StageResult IndexScan(unsigned a_ThreadCount) {
+    MappedFile index{};
+    index.Open(JoinPath(m_CorpusDir, "index.xml"));
+    auto start = BenchClock::now();
+    auto result = StageResult{"index scan"};
+    auto allocations = ThreadAllocations().count;
+    auto compounds = std::vector<CompoundRef>{};
+
+    ScanIndex(index.Data(), index.Size(), a_ThreadCount, compounds);
+    m_Checksum += compounds.size();
+
+    result.seconds = SecondsSince(start);
+    result.bytes = index.Size();
+    result.compounds = compounds.size();
+    result.allocations = AllocationsSince(allocations);
+    return result;
+  }
+
+  // The old way of getting at the documentation, every compound is turned into a json string
+  StageResult XmlToJson() {
+    auto start = BenchClock::now();
+    auto result = StageResult{"xml to json"};
+    auto allocations = ThreadAllocations().count;
+    auto xml = std::string{};
+
+    m_JsonStrings.resize(m_Files.size());
+    for (auto i = size_t{0}; i < m_Files.size(); i++) {
+      // xml2json parses in place, the mapped files still have to be parsed by tinyxml2 afterwards
+      xml.assign(m_Files[i].Data(), m_Files[i].Size());
+      m_JsonStrings[i] = xml2json(&xml[0], xml2json_in_situ);
+      result.bytes += xml.size();
+    }
+
+    result.seconds = SecondsSince(start);
+    result.compounds = m_Files.size();
+    result.allocations = AllocationsSince(allocations);
+    return result;
+  }
+
+  // Parses the json with the json type that the generator uses and with the default one it replaced, the
+  // difference between the two is what keeping objects in a FlatMap and the values in an arena saves. Every
+  // compound gets an arena of its own like it does in the generator, the default json doesn't use it
+  template <typename Json>
+  StageResult JsonParse(const char* a_Name) {
+    auto start = BenchClock::now();
+    auto result = StageResult{a_Name};
+    auto allocations = ThreadAllocations().count;
+
+    for (auto& jsonString : m_JsonStrings) {
+      JsonArena arena{};
+      JsonArenaScope arenaScope{&arena};
+      auto parsed = Json::parse(jsonString.c_str());
+      m_Checksum += parsed.size();
+      result.bytes += jsonString.size();
+    }
+
+    result.seconds = SecondsSince(start);
+    result.compounds = m_JsonStrings.size();
+    result.allocations = AllocationsSince(allocations);
+    return result;
+  }
+
+  // The same json parsed with rapidjson right inside of a copy of the string, the strings aren't copied a second time
+  StageResult JsonParseInsitu() {
+    auto start = BenchClock::now();
+    auto result = StageResult{"json in situ"};
+    auto allocations = ThreadAllocations().count;
+    auto buffer = std::string{};
+
+    for (auto& jsonString : m_JsonStrings) {
+      buffer.assign(jsonString);
+      rapidjson::Document parsed{};
+      xml2json_parse_insitu(buffer, parsed);
+      m_Checksum += parsed.IsObject() ? parsed.MemberCount() : 0;
+      result.bytes += jsonString.size();
+    }
+
+    result.seconds = SecondsSince(start);
+    result.compounds = m_JsonStrings.size();
+    result.allocations = AllocationsSince(allocations);
+    return result;
+  }
+
+  // Streams the mapped files and extracts the script binds in the same pass, this has to run before the files
+  // are parsed in place since tinyxml2 leaves them behind with its strings terminated
+  StageResult Stream() {
+    auto start = BenchClock::now();
+    auto result = StageResult{"stream"};
+    auto allocations = ThreadAllocations().count;
+    ExtractScratch scratch{};
+    CompoundResult compound{};
+    auto error = tinyxml2::XML_SUCCESS;
+
+    for (auto& file : m_Files) {
+      compound = CompoundResult{};
+      JsonArenaScope arenaScope{compound.arena.Reset()};
+      compound.extracted = StreamScriptBind(file.Data(), file.Size(), scratch, compound.name, compound.scriptbind,
+                                            compound.warnings, error);
+      m_Checksum += compound.extracted ? compound.scriptbind[g_MethodsKey].size() : 0;
+      result.bytes += file.Size();
+    }
+
+    result.seconds = SecondsSince(start);
+    result.compounds = m_Files.size();
+    result.allocations = AllocationsSince(allocations);
+    return result;
+  }
+
+  // Parses the mapped files with tinyxml2 and extracts the script binds out of them exactly like the generator
+  // does on a single thread. Parsing and extracting take turns per file so they are timed one file at a time
+  void Extract(StageResult& a_Parse, StageResult& a_Extract) {
+    a_Parse = StageResult{"xml parse"};
+    a_Extract = StageResult{"extraction"};
+    tinyxml2::XMLDocument xmlDoc{};
+    ExtractScratch scratch{};
+
+    m_Cache.compounds.clear();
+    for (auto i = size_t{0}; i < m_Files.size(); i++) {
+      auto& entry = m_Cache.compounds[m_Cache.index[i].fileName];
+      auto start = BenchClock::now();
+      auto allocations = ThreadAllocations().count;
+      xmlDoc.ParseInPlace(m_Files[i].Data(), m_Files[i].Size());
+      a_Parse.seconds += SecondsSince(start);
+      a_Parse.allocations += AllocationsSince(allocations);
+      a_Parse.bytes += m_Files[i].Size();
+
+      start = BenchClock::now();
+      allocations = ThreadAllocations().count;
+      JsonArenaScope arenaScope{entry.result.arena.Reset()};
+      entry.result.extracted = ExtractScriptBind(xmlDoc, scratch, entry.result.name, entry.result.scriptbind, entry.result.warnings);
+      a_Extract.seconds += SecondsSince(start);
+      a_Extract.allocations += AllocationsSince(allocations);
+      a_Extract.bytes += m_Files[i].Size();
+
+      xmlDoc.Clear();
+    }
+
+    a_Parse.compounds = m_Files.size();
+    a_Extract.compounds = m_Files.size();
+    m_Files.clear();
+  }
+
+  StageResult Serialize(bool a_Compact) {
+    auto filePath = JoinPath(m_OutputDir, "scriptbinds.json");
+    auto start = BenchClock::now();
+    auto result = StageResult{a_Compact ? "write compact" : "write pretty"};
+    auto allocations = ThreadAllocations().count;
+
+    WriteScriptBinds(filePath, m_Cache, a_Compact);
+
+    result.seconds = SecondsSince(start);
+    result.allocations = AllocationsSince(allocations);
+    auto error = std::error_code{};
+    result.bytes = static_cast<size_t>(std::filesystem::file_size(filePath, error));
+    result.compounds = m_Cache.compounds.size();
+    return result;
+  }
+
+  // The pre-indexed file for the editor's autocomplete, it's written next to scriptbinds.json when asked for
+  StageResult SerializeIndex() {
+    auto filePath = JoinPath(m_OutputDir, "scriptbinds.index.json");
+    auto start = BenchClock::now();
+    auto result = StageResult{"write index"};
+    auto allocations = ThreadAllocations().count;
+
+    WriteScriptBindIndex(filePath, m_Cache);
+
+    result.seconds = SecondsSince(start);
+    result.allocations = AllocationsSince(allocations);
+    auto error = std::error_code{};
+    result.bytes = static_cast<size_t>(std::filesystem::file_size(filePath, error));
+    result.compounds = m_Cache.compounds.size();
+    return result;
+  }
+
+  // Keeps the compiler from deciding that the stages don't do anything
+  size_t Checksum() const { return m_Checksum; }
+
+private:
+  std::string m_CorpusDir;
+  std::string m_OutputDir;
+  MappedFile m_Index;
+  std::vector<MappedFile> m_Files;
+  std::vector<std::string> m_JsonStrings;
+  ExtractionCache m_Cache;
+  size_t m_Checksum = 0;
+};
+
+// The whole generator the way the command runs it, without a cache
+StageResult RunGenerator(const GeneratorSettings& a_Settings, size_t a_Bytes, size_t a_Compounds) {
+  auto start = BenchClock::now();
+  auto result = StageResult{"end to end"};
+  GeneratorState state{};
+  Generate(a_Settings, state, nullptr);
+  result.seconds = SecondsSince(start);
+
+  // The generator counts the allocations of its worker threads itself
+  for (auto& stage : state.stats.stages) {
+    result.allocations += stage.allocations;
+  }
+  result.bytes = a_Bytes;
+  result.compounds = a_Compounds;
+  return result;
+}
+
+void PrintStage(const StageResult& a_Stage) {
+  auto megabytes = a_Stage.bytes / (1024.0 * 1024.0);
+  auto seconds = std::max(a_Stage.seconds, 1e-9);
+  printf("  %-14s %10.2f ms %10.1f MB/s %12.0f compounds/s %10llu allocations\n", a_Stage.name, a_Stage.seconds * 1000.0,
+         megabytes / seconds, a_Stage.compounds / seconds, static_cast<unsigned long long>(a_Stage.allocations));
+}
+
+int main(int argc, char* argv[]) {
+  CorpusSettings corpus{};
+  corpus.dir = "bench_corpus";
+  auto outputDir = std::string("bench_output");
+  auto runs = 5u;
+  auto threadCount = 1u;
+  auto allocationBudget = g_DefaultAllocationBudget;
+
+  // Checking each argument passed to the command, every option is followed by its value
+  for (auto i = 1; i < argc; i += 2) {
+    auto value = i + 1 < argc ? argv[i + 1] : "";
+    if (strcmp("--dir", argv[i]) == 0) {
+      corpus.dir = value;
+    }
+    else if (strcmp("-o", argv[i]) == 0) {
+      outputDir = value;
+    }
+    else if (strcmp("--compounds", argv[i]) == 0) {
+      corpus.compounds = static_cast<unsigned>(std::max(atoi(value), 1));
+    }
+    else if (strcmp("--methods", argv[i]) == 0) {
+      corpus.methods = static_cast<unsigned>(std::max(atoi(value), 1));
+    }
+    else if (strcmp("--params", argv[i]) == 0) {
+      corpus.params = static_cast<unsigned>(std::max(atoi(value), 0));
+    }
+    else if (strcmp("--ulinks", argv[i]) == 0) {
+      corpus.ulinks = atof(value);
+    }
+    else if (strcmp("--retvals", argv[i]) == 0) {
+      corpus.retvals = atof(value);
+    }
+    else if (strcmp("--seed", argv[i]) == 0) {
+      corpus.seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+    }
+    else if (strcmp("--runs", argv[i]) == 0) {
+      runs = static_cast<unsigned>(std::max(atoi(value), 1));
+    }
+    else if (strcmp("-j", argv[i]) == 0) {
+      threadCount = static_cast<unsigned>(std::max(atoi(value), 1));
+    }
+    else if (strcmp("--alloc-budget", argv[i]) == 0) {
+      allocationBudget = atof(value);
+    }
+    else {
+      printf("\nHelp for atom_hexe_bench:\n\n"
+             "    --dir \"corpus_dir\"  Where the synthetic doxygen output is generated (defaults to bench_corpus)\n"
+             "    -o \"output_dir\"     Where the JSON file is written (defaults to bench_output)\n"
+             "    --compounds n       Amount of script binds to generate (defaults to 500)\n"
+             "    --methods n         Most methods a script bind gets (defaults to 12)\n"
+             "    --params n          Most parameters a method gets (defaults to 4)\n"
+             "    --ulinks f          Fraction of descriptions that span lines and contain a link (defaults to 0.25)\n"
+             "    --retvals f         Fraction of methods with a retval list (defaults to 0.5)\n"
+             "    --seed n            Seed for the generator, the same seed always gives the same corpus\n"
+             "    --runs n            Amount of times every stage is run, the fastest run is reported (defaults to 5)\n"
+             "    -j threads          Amount of threads for the end to end run (defaults to 1)\n"
+             "    --alloc-budget n    Fail when extraction allocates more than this per method (defaults to 16, 0 turns it off)\n");
+      return argv[i][0] == '-' && argv[i][1] == 'h' ? 0 : -1;
+    }
+  }
+
+  // Every stage reports how much it allocated
+  CountAllocations();
+
+  auto corpusInfo = CorpusInfo{};
+  auto error = std::error_code{};
+  std::filesystem::create_directories(outputDir, error);
+  if (!GenerateCorpus(corpus, corpusInfo)) {
+    printf("Couldn't generate the corpus in %s\n", corpus.dir.c_str());
+    return -1;
+  }
+
+  printf("Corpus: %u script binds, %u methods, %.2f MB of compounds and %.2f MB of index\n", corpusInfo.scriptBinds,
+         corpusInfo.methods, corpusInfo.compoundBytes / (1024.0 * 1024.0), corpusInfo.indexBytes / (1024.0 * 1024.0));
+
+  StageResult load{}, indexScan{}, xmlToJson{}, jsonParse{}, jsonParseStdMap{}, jsonInsitu{}, stream{}, xmlParse{}, extraction{}, writePretty{}, writeCompact{}, writeIndex{}, endToEnd{};
+  auto checksum = size_t{0};
+
+  GeneratorSettings settings{};
+  settings.inputDir = corpus.dir;
+  settings.outputDir = outputDir;
+  settings.threadCount = threadCount;
+  settings.useCache = false;
+
+  for (auto run = 0u; run < runs; run++) {
+    BenchRun bench{corpus.dir, outputDir};
+    KeepFastest(load, bench.Load());
+    KeepFastest(indexScan, bench.IndexScan(threadCount));
+    KeepFastest(xmlToJson, bench.XmlToJson());
+    KeepFastest(jsonParse, bench.JsonParse<json>("json parse"));
+    KeepFastest(jsonParseStdMap, bench.JsonParse<nlohmann::json>("json std::map"));
+    KeepFastest(jsonInsitu, bench.JsonParseInsitu());
+    KeepFastest(stream, bench.Stream());
+
+    StageResult parseRun{}, extractRun{};
+    bench.Extract(parseRun, extractRun);
+    KeepFastest(xmlParse, parseRun);
+    KeepFastest(extraction, extractRun);
+
+    KeepFastest(writePretty, bench.Serialize(false));
+    KeepFastest(writeCompact, bench.Serialize(true));
+    KeepFastest(writeIndex, bench.SerializeIndex());
+    checksum += bench.Checksum();
+
+    KeepFastest(endToEnd, RunGenerator(settings, load.bytes, load.compounds));
+  }
+
+  printf("Fastest of %u runs:\n", runs);
+  for (auto stage : {&load, &indexScan, &xmlToJson, &jsonParse, &jsonParseStdMap, &jsonInsitu, &stream, &xmlParse, &extraction, &writePretty, &writeCompact, &writeIndex, &endToEnd}) {
+    PrintStage(*stage);
+  }
+  printf("Peak memory: %.1f MB (checksum %zu)\n", PeakMemoryBytes() / (1024.0 * 1024.0), checksum);
+
+  // Extraction is supposed to build the json for a method in place without copying anything around, so how much it
+  // allocates per method only goes up when something starts making copies again
+  auto allocationsPerMethod = static_cast<double>(extraction.allocations) / std::max(corpusInfo.methods, 1u);
+  printf("Extraction allocations: %.1f per method\n", allocationsPerMethod);
+  if (allocationBudget > 0.0 && allocationsPerMethod > allocationBudget) {
+    printf("That's over the budget of %.1f allocations per method\n", allocationBudget);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,196 @@
+#include "corpus.h"
+#include "generator.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+// A mix of types that are in the type table, spelled the different ways doxygen spells them, and a couple
+// that aren't so the unknown type path gets some work as well
+const char* g_CorpusTypes[] = {
+  "int", "float", "bool", "double", "unsigned int", "uint32_t", "const char *", "ScriptHandle",
+  "glm::vec2", "const glm::vec3", "ScriptTable", "hexe::service::scripts::SmartScriptTable",
+  "hexe::gameplay::tile::TileCoord", "component::Entity", "input::KeyCode", "const std::string &", "Widget *"
+};
+const char* g_CorpusRetvals[] = { "bool", "int", "float", "ScriptTable", "Entity", "nothing" };
+
+const char* g_EngineNamespace = "hexe::service::scripts::scriptbinds";
+const char* g_EngineRefid = "classhexe_1_1service_1_1scripts_1_1scriptbinds_1_1";
+const char* g_GameNamespace = "hexegame::scriptbinds";
+const char* g_GameRefid = "classhexegame_1_1scriptbinds_1_1";
+
+// printf straight onto the end of a string
+void AppendFormat(std::string& a_Out, const char* a_Format, ...) {
+  char buffer[1024];
+  va_list args;
+  va_start(args, a_Format);
+  auto length = vsnprintf(buffer, sizeof(buffer), a_Format, args);
+  va_end(args);
+  if (length > 0) {
+    a_Out.append(buffer, std::min<size_t>(length, sizeof(buffer) - 1));
+  }
+}
+
+bool WriteWholeFile(const std::string& a_FilePath, const std::string& a_Contents) {
+  auto file = fopen(a_FilePath.c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+  auto written = fwrite(a_Contents.data(), 1, a_Contents.size(), file);
+  return fclose(file) == 0 && written == a_Contents.size();
+}
+
+class CorpusWriter {
+public:
+  explicit CorpusWriter(const CorpusSettings& a_Settings) : m_Settings(a_Settings), m_Random(a_Settings.seed) {}
+
+  // Random number from 0 up to and including a_Max
+  unsigned Pick(unsigned a_Max) { return a_Max > 0 ? m_Random() % (a_Max + 1) : 0; }
+  bool Chance(double a_Fraction) { return (m_Random() % 10000) < a_Fraction * 10000; }
+
+  // Doxygen keeps the line breaks of the comment, links end up as ulink elements in the middle of the text
+  void AppendDescription(std::string& a_Out, const char* a_What, unsigned a_Id) {
+    if (Chance(m_Settings.ulinks)) {
+      AppendFormat(a_Out, "<para>%s %u, the behaviour is described\nin more detail over at <ulink url=\"https://docs.example.com/scriptbinds/%u\">"
+                   "the docs</ulink> and\n  it can change between versions &amp; platforms </para>\n", a_What, a_Id, a_Id);
+    }
+    else {
+      AppendFormat(a_Out, "<para>%s %u &lt;see the header&gt; </para>\n", a_What, a_Id);
+    }
+  }
+
+  void AppendMember(std::string& a_Out, const std::string& a_Refid, unsigned a_Id, const std::string& a_Name, bool a_IsMethod) {
+    AppendFormat(a_Out, "      <memberdef kind=\"function\" id=\"%s_1a%u\" prot=\"public\" static=\"no\" const=\"no\" explicit=\"no\" "
+                 "inline=\"no\" virt=\"non-virtual\">\n", a_Refid.c_str(), a_Id);
+    AppendFormat(a_Out, "        <type>int</type>\n        <definition>int %s</definition>\n", a_Name.c_str());
+    AppendFormat(a_Out, "        <argsstring>(IFunctionHandler *pH)</argsstring>\n        <name>%s</name>\n", a_Name.c_str());
+
+    // The function handler always comes first, it isn't documented
+    auto paramCount = a_IsMethod ? Pick(m_Settings.params) : 0;
+    a_Out += "        <param>\n          <type>IFunctionHandler *</type>\n          <declname>pH</declname>\n        </param>\n";
+    for (auto i = 0u; i < paramCount; i++) {
+      auto type = std::string(g_CorpusTypes[Pick(sizeof(g_CorpusTypes) / sizeof(g_CorpusTypes[0]) - 1)]);
+      for (auto pos = type.find('&'); pos != std::string::npos; pos = type.find('&', pos + 1)) {
+        type.replace(pos, 1, "&amp;");
+      }
+      AppendFormat(a_Out, "        <param>\n          <type>%s</type>\n          <declname>a_Param%u</declname>\n        </param>\n",
+                   type.c_str(), i);
+    }
+
+    a_Out += "        <briefdescription>\n";
+    if (a_IsMethod) {
+      AppendDescription(a_Out, "Does the thing number", a_Id);
+    }
+    a_Out += "        </briefdescription>\n        <detaileddescription>\n";
+
+    auto hasRetvals = a_IsMethod && Chance(m_Settings.retvals);
+    if (paramCount > 0 || hasRetvals) {
+      a_Out += "<para>";
+      if (paramCount > 0) {
+        a_Out += "<parameterlist kind=\"param\">";
+        for (auto i = 0u; i < paramCount; i++) {
+          AppendFormat(a_Out, "<parameteritem>\n<parameternamelist>\n<parametername>a_Param%u</parametername>\n"
+                       "</parameternamelist>\n<parameterdescription>\n", i);
+          AppendDescription(a_Out, "The parameter", i);
+          a_Out += "</parameterdescription>\n</parameteritem>\n";
+        }
+        a_Out += "</parameterlist>";
+      }
+      if (hasRetvals) {
+        a_Out += "<parameterlist kind=\"retval\">";
+        for (auto i = 0u, count = 1 + Pick(1); i < count; i++) {
+          auto type = g_CorpusRetvals[Pick(sizeof(g_CorpusRetvals) / sizeof(g_CorpusRetvals[0]) - 1)];
+          AppendFormat(a_Out, "<parameteritem>\n<parameternamelist>\n<parametername>%s</parametername>\n"
+                       "</parameternamelist>\n<parameterdescription>\n", type);
+          AppendDescription(a_Out, "Returned value", i);
+          a_Out += "</parameterdescription>\n</parameteritem>\n";
+        }
+        a_Out += "</parameterlist>";
+      }
+      a_Out += "</para>\n";
+    }
+
+    AppendFormat(a_Out, "        </detaileddescription>\n        <inbodydescription>\n        </inbodydescription>\n"
+                 "        <location file=\"ScriptBind.h\" line=\"%u\" column=\"1\"/>\n      </memberdef>\n", a_Id + 10);
+  }
+
+  bool Write(CorpusInfo& a_Info) {
+    auto index = std::string{};
+    auto compound = std::string{};
+
+    index += "<?xml version='1.0' encoding='UTF-8' standalone='no'?>\n"
+             "<doxygenindex xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xsi:noNamespaceSchemaLocation=\"index.xsd\" "
+             "version=\"1.8.13\">\n";
+
+    for (auto i = 0u; i < m_Settings.compounds; i++) {
+      // Every third script bind comes from the game instead of the engine
+      auto isGame = i % 3 == 2;
+      auto className = "ScriptBind_Bench" + std::to_string(i);
+      auto fullName = std::string(isGame ? g_GameNamespace : g_EngineNamespace) + "::" + className;
+      auto refid = std::string(isGame ? g_GameRefid : g_EngineRefid) + "ScriptBind__Bench" + std::to_string(i);
+      auto methodCount = 1 + Pick(m_Settings.methods > 0 ? m_Settings.methods - 1 : 0);
+
+      compound.clear();
+      compound += "<?xml version='1.0' encoding='UTF-8' standalone='no'?>\n"
+                  "<doxygen xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xsi:noNamespaceSchemaLocation=\"compound.xsd\" "
+                  "version=\"1.8.13\">\n";
+      AppendFormat(compound, "  <compounddef id=\"%s\" kind=\"class\" language=\"C++\" prot=\"public\">\n", refid.c_str());
+      AppendFormat(compound, "    <compoundname>%s</compoundname>\n", fullName.c_str());
+      AppendFormat(compound, "    <includes local=\"no\">%s.h</includes>\n", className.c_str());
+      compound += "      <sectiondef kind=\"private-attrib\">\n"
+                  "      <memberdef kind=\"variable\" prot=\"private\" static=\"no\" mutable=\"no\">\n"
+                  "        <type>IScriptSystem *</type>\n        <name>m_pSS</name>\n"
+                  "        <briefdescription>\n        </briefdescription>\n"
+                  "        <detaileddescription>\n        </detaileddescription>\n      </memberdef>\n"
+                  "      </sectiondef>\n      <sectiondef kind=\"public-func\">\n";
+
+      AppendFormat(index, "  <compound refid=\"%s\" kind=\"class\"><name>%s</name>\n", refid.c_str(), fullName.c_str());
+      AppendMember(compound, refid, 0, className, false);
+      for (auto m = 1u; m <= methodCount; m++) {
+        auto methodName = "Method" + std::to_string(m);
+        AppendMember(compound, refid, m, methodName, true);
+        AppendFormat(index, "    <member refid=\"%s_1a%u\" kind=\"function\"><name>%s</name></member>\n", refid.c_str(), m,
+                     methodName.c_str());
+      }
+      index += "  </compound>\n";
+
+      compound += "      </sectiondef>\n    <briefdescription>\n";
+      AppendDescription(compound, "Script bind for bench thing", i);
+      AppendFormat(compound, "    </briefdescription>\n    <detaileddescription>\n    </detaileddescription>\n"
+                   "    <location file=\"%s.h\" line=\"1\" column=\"1\"/>\n  </compounddef>\n</doxygen>\n", className.c_str());
+
+      if (!WriteWholeFile(JoinPath(m_Settings.dir, refid + ".xml"), compound)) {
+        return false;
+      }
+
+      // Plenty of what doxygen lists isn't a script bind, those have to be skipped over in the index
+      AppendFormat(index, "  <compound refid=\"classhexe_1_1Helper%u\" kind=\"class\"><name>hexe::Helper%u</name>\n  </compound>\n", i, i);
+
+      a_Info.scriptBinds++;
+      a_Info.methods += methodCount;
+      a_Info.compoundBytes += compound.size();
+    }
+
+    index += "  <compound refid=\"namespacehexe\" kind=\"namespace\"><name>hexe</name>\n  </compound>\n</doxygenindex>\n";
+    a_Info.indexBytes = index.size();
+    return WriteWholeFile(JoinPath(m_Settings.dir, "index.xml"), index);
+  }
+
+private:
+  const CorpusSettings& m_Settings;
+  std::mt19937 m_Random;
+};
+
+bool GenerateCorpus(const CorpusSettings& a_Settings, CorpusInfo& a_Info) {
+  auto error = std::error_code{};
+  std::filesystem::create_directories(a_Settings.dir, error);
+  if (error) {
+    return false;
+  }
+
+  a_Info = CorpusInfo{};
+  CorpusWriter writer{a_Settings};
+  return writer.Write(a_Info);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// What the synthetic doxygen output should look like. The counts are the most a compound or method gets,
+// the generator picks a random amount up to them so that the files aren't all the same size
+struct CorpusSettings {
+  std::string dir;
+  unsigned compounds = 500;
+  unsigned methods = 12;
+  unsigned params = 4;
+  // Fraction of descriptions that span multiple lines with a link in the middle of them
+  double ulinks = 0.25;
+  // Fraction of methods that document their own return values
+  double retvals = 0.5;
+  uint32_t seed = 1;
+};
+
+// What ended up on disk, the bench uses this to turn its timings into throughput
+struct CorpusInfo {
+  unsigned scriptBinds = 0;
+  unsigned methods = 0;
+  size_t indexBytes = 0;
+  size_t compoundBytes = 0;
+};
+
+// Writes index.xml and a ScriptBind_* compound file for every script bind into a_Settings.dir, along with
+// a few compounds that aren't script binds the same way doxygen lists every class it finds
+bool GenerateCorpus(const CorpusSettings& a_Settings, CorpusInfo& a_Info);
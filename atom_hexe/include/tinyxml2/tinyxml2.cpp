@@ -100,6 +100,20 @@ distribution.
 	#define TIXML_SSCANF   sscanf
 #endif
 
+// SSE2 is always there on x64 (and is what MSVC builds for on x86 by default), AVX2 is only used when
+// the cpu says it has it
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#define TIXML_SSE2
+	#include <emmintrin.h>
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define TIXML_TARGET_AVX2
+	#else
+		#define TIXML_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+	#endif
+#endif
+
 
 static const char LINE_FEED				= (char)0x0a;			// all line endings are normalized to LF
 static const char LF = LINE_FEED;
@@ -200,17 +214,17 @@ char* StrPair::ParseText( char* p, const char* endTag, int strFlags, int* curLin
     size_t length = strlen( endTag );
 
     // Inner loop of text parsing.
-    while ( *p ) {
-        if ( *p == endChar && strncmp( p, endTag, length ) == 0 ) {
+    for ( ;; ) {
+        p = const_cast<char*>( XMLUtil::FindChar( p, 0, endChar, curLineNumPtr ) );
+        if ( !*p ) {
+            return 0;
+        }
+        if ( strncmp( p, endTag, length ) == 0 ) {
             Set( start, p, strFlags );
             return p + length;
-        } else if (*p == '\n') {
-            ++(*curLineNumPtr);
         }
         ++p;
-        TIXMLASSERT( p );
     }
-    return 0;
 }
 
 
@@ -275,7 +289,26 @@ const char* StrPair::GetStr()
             const char* p = _start;	// the read pointer
             char* q = _start;	// the write pointer
 
+            // Only line breaks and entities need a closer look, everything in between is moved in one go
+            char specials[4] = { 0 };
+            int numSpecials = 0;
+            if ( _flags & NEEDS_NEWLINE_NORMALIZATION ) {
+                specials[numSpecials++] = CR;
+                specials[numSpecials++] = LF;
+            }
+            if ( _flags & NEEDS_ENTITY_PROCESSING ) {
+                specials[numSpecials++] = '&';
+            }
+
             while( p < _end ) {
+                const char* special = XMLUtil::FindChars( p, _end, specials );
+                if ( special != p ) {
+                    memmove( q, p, special - p );
+                    q += special - p;
+                    p = special;
+                    continue;
+                }
+
                 if ( (_flags & NEEDS_NEWLINE_NORMALIZATION) && *p == CR ) {
                     // CR-LF pair becomes LF
                     // CR alone becomes LF
@@ -368,6 +401,249 @@ const char* StrPair::GetStr()
 
 // --------- XMLUtil ----------- //
 
+namespace
+{
+
+// The characters a scan stops at, a scan that compares against fewer than four only looks at the first ones.
+// A scan that doesn't compare against any stops at the end of whitespace instead
+struct ScanSet {
+    char chars[4];
+};
+
+#ifdef TIXML_SSE2
+
+inline int FirstBit( unsigned v )
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward( &index, v );
+    return static_cast<int>( index );
+#else
+    return __builtin_ctz( v );
+#endif
+}
+
+// Bits for the bytes of a block that are in front of position, position can be anything up to 32
+inline unsigned BitsBefore( ptrdiff_t position )
+{
+    return static_cast<unsigned>( ( static_cast<unsigned long long>( 1 ) << position ) - 1 );
+}
+
+// A cpu with only SSE2 doesn't have to have popcnt, so the bits are counted by hand
+inline int CountBits( unsigned v )
+{
+    v = v - ( ( v >> 1 ) & 0x55555555u );
+    v = ( v & 0x33333333u ) + ( ( v >> 2 ) & 0x33333333u );
+    return static_cast<int>( ( ( ( v + ( v >> 4 ) ) & 0x0F0F0F0Fu ) * 0x01010101u ) >> 24 );
+}
+
+// Every cpu with AVX2 has popcnt as well
+TIXML_TARGET_AVX2 inline int CountBitsAVX2( unsigned v )
+{
+#if defined(_MSC_VER)
+    return static_cast<int>( __popcnt( v ) );
+#else
+    return __builtin_popcount( v );
+#endif
+}
+
+bool HasAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid( info, 0 );
+    if ( info[0] < 7 ) {
+        return false;
+    }
+    // The cpu has to support it and the os has to save the ymm registers
+    __cpuid( info, 1 );
+    const bool osxsave = ( info[2] & ( 1 << 27 ) ) != 0;
+    __cpuidex( info, 7, 0 );
+    return osxsave && ( info[1] & ( 1 << 5 ) ) != 0 && ( _xgetbv( 0 ) & 6 ) == 6;
+#else
+    // Nothing guarantees that the cpu model was filled in yet when this runs, so it's done here first
+    __builtin_cpu_init();
+    return __builtin_cpu_supports( "avx2" ) != 0;
+#endif
+}
+
+// Which scan is used is decided once while the program starts up instead of on every call. Anything that is
+// scanned while other files' globals are being set up, before this one is, sees false and takes the SSE2 scan,
+// which every cpu this is built for has
+const bool hasAVX2 = HasAVX2();
+
+// Both scans work the same way and only differ in how wide a block is. The first block starts at the aligned
+// address in front of p, the bytes in it that come before p are ignored
+template<int NumChars>
+const char* ScanSSE2( const char* p, const char* end, const ScanSet& set, int* curLineNumPtr )
+{
+    const __m128i char0 = _mm_set1_epi8( set.chars[0] );
+    const __m128i char1 = _mm_set1_epi8( set.chars[1] );
+    const __m128i char2 = _mm_set1_epi8( set.chars[2] );
+    const __m128i char3 = _mm_set1_epi8( set.chars[3] );
+    const __m128i lineFeed = _mm_set1_epi8( LF );
+
+    const ptrdiff_t offset = reinterpret_cast<uintptr_t>( p ) & 15;
+    const char* block = p - offset;
+    unsigned looked = ~0u << offset;
+    for ( ;; ) {
+        const __m128i bytes = _mm_load_si128( reinterpret_cast<const __m128i*>( block ) );
+        unsigned found = 0;
+        if ( NumChars == 0 ) {
+            // Whitespace is a space or anything from \t to \r
+            const __m128i control = _mm_sub_epi8( bytes, _mm_set1_epi8( '\t' ) );
+            const __m128i isControl = _mm_cmpeq_epi8( _mm_min_epu8( control, _mm_set1_epi8( '\r' - '\t' ) ), control );
+            const __m128i isWhiteSpace = _mm_or_si128( isControl, _mm_cmpeq_epi8( bytes, _mm_set1_epi8( ' ' ) ) );
+            found = ~static_cast<unsigned>( _mm_movemask_epi8( isWhiteSpace ) ) & 0xFFFFu;
+        }
+        else {
+            __m128i match = _mm_cmpeq_epi8( bytes, char0 );
+            if ( NumChars > 1 ) {
+                match = _mm_or_si128( match, _mm_cmpeq_epi8( bytes, char1 ) );
+            }
+            if ( NumChars > 2 ) {
+                match = _mm_or_si128( match, _mm_or_si128( _mm_cmpeq_epi8( bytes, char2 ), _mm_cmpeq_epi8( bytes, char3 ) ) );
+            }
+            found = static_cast<unsigned>( _mm_movemask_epi8( match ) );
+        }
+        found &= looked;
+
+        const char* stop = found ? block + FirstBit( found ) : block + 16;
+        if ( end && stop > end ) {
+            stop = end;
+        }
+        if ( curLineNumPtr ) {
+            const unsigned lineFeeds = static_cast<unsigned>( _mm_movemask_epi8( _mm_cmpeq_epi8( bytes, lineFeed ) ) );
+            *curLineNumPtr += CountBits( lineFeeds & looked & BitsBefore( stop - block ) );
+        }
+        if ( stop != block + 16 || stop == end ) {
+            return stop;
+        }
+        block += 16;
+        looked = ~0u;
+    }
+}
+
+template<int NumChars>
+TIXML_TARGET_AVX2 const char* ScanAVX2( const char* p, const char* end, const ScanSet& set, int* curLineNumPtr )
+{
+    const __m256i char0 = _mm256_set1_epi8( set.chars[0] );
+    const __m256i char1 = _mm256_set1_epi8( set.chars[1] );
+    const __m256i char2 = _mm256_set1_epi8( set.chars[2] );
+    const __m256i char3 = _mm256_set1_epi8( set.chars[3] );
+    const __m256i lineFeed = _mm256_set1_epi8( LF );
+
+    const ptrdiff_t offset = reinterpret_cast<uintptr_t>( p ) & 31;
+    const char* block = p - offset;
+    unsigned looked = ~0u << offset;
+    for ( ;; ) {
+        const __m256i bytes = _mm256_load_si256( reinterpret_cast<const __m256i*>( block ) );
+        unsigned found = 0;
+        if ( NumChars == 0 ) {
+            const __m256i control = _mm256_sub_epi8( bytes, _mm256_set1_epi8( '\t' ) );
+            const __m256i isControl = _mm256_cmpeq_epi8( _mm256_min_epu8( control, _mm256_set1_epi8( '\r' - '\t' ) ), control );
+            const __m256i isWhiteSpace = _mm256_or_si256( isControl, _mm256_cmpeq_epi8( bytes, _mm256_set1_epi8( ' ' ) ) );
+            found = ~static_cast<unsigned>( _mm256_movemask_epi8( isWhiteSpace ) );
+        }
+        else {
+            __m256i match = _mm256_cmpeq_epi8( bytes, char0 );
+            if ( NumChars > 1 ) {
+                match = _mm256_or_si256( match, _mm256_cmpeq_epi8( bytes, char1 ) );
+            }
+            if ( NumChars > 2 ) {
+                match = _mm256_or_si256( match, _mm256_or_si256( _mm256_cmpeq_epi8( bytes, char2 ), _mm256_cmpeq_epi8( bytes, char3 ) ) );
+            }
+            found = static_cast<unsigned>( _mm256_movemask_epi8( match ) );
+        }
+        found &= looked;
+
+        const char* stop = found ? block + FirstBit( found ) : block + 32;
+        if ( end && stop > end ) {
+            stop = end;
+        }
+        if ( curLineNumPtr ) {
+            const unsigned lineFeeds = static_cast<unsigned>( _mm256_movemask_epi8( _mm256_cmpeq_epi8( bytes, lineFeed ) ) );
+            *curLineNumPtr += CountBitsAVX2( lineFeeds & looked & BitsBefore( stop - block ) );
+        }
+        if ( stop != block + 32 || stop == end ) {
+            return stop;
+        }
+        block += 32;
+        looked = ~0u;
+    }
+}
+
+#endif
+
+template<int NumChars>
+inline const char* Scan( const char* p, const char* end, const ScanSet& set, int* curLineNumPtr )
+{
+    TIXMLASSERT( p );
+#ifdef TIXML_SSE2
+    return hasAVX2 ? ScanAVX2<NumChars>( p, end, set, curLineNumPtr ) : ScanSSE2<NumChars>( p, end, set, curLineNumPtr );
+#else
+    for ( ; p != end; ++p ) {
+        bool found = NumChars == 0 && !XMLUtil::IsWhiteSpace( *p );
+        for ( int i = 0; i < NumChars && !found; ++i ) {
+            found = *p == set.chars[i];
+        }
+        if ( found ) {
+            break;
+        }
+        if ( curLineNumPtr && *p == LF ) {
+            ++(*curLineNumPtr);
+        }
+    }
+    return p;
+#endif
+}
+
+}
+
+
+const char* XMLUtil::SkipWhiteSpace( const char* p, const char* end, int* curLineNumPtr )
+{
+    // The terminating null isn't whitespace, so it stops the scan without being looked for
+    const ScanSet set = { { 0, 0, 0, 0 } };
+    return Scan<0>( p, end, set, curLineNumPtr );
+}
+
+
+const char* XMLUtil::FindChar( const char* p, const char* end, char ch, int* curLineNumPtr )
+{
+    // Without an end the terminating null is what stops the scan
+    const ScanSet set = { { ch, 0, 0, 0 } };
+    return end ? Scan<1>( p, end, set, curLineNumPtr ) : Scan<2>( p, end, set, curLineNumPtr );
+}
+
+
+const char* XMLUtil::FindChars( const char* p, const char* end, const char* chars, int* curLineNumPtr )
+{
+    // Slots that aren't needed repeat the first character, so the scan can always compare against all four
+    ScanSet set = { { chars[0], chars[0], chars[0], chars[0] } };
+    int numChars = 0;
+    while ( chars[numChars] ) {
+        TIXMLASSERT( numChars < 3 );
+        set.chars[numChars] = chars[numChars];
+        ++numChars;
+    }
+    if ( !end ) {
+        set.chars[numChars++] = 0;
+    }
+
+    switch ( numChars ) {
+        case 0:
+            return end;
+        case 1:
+            return Scan<1>( p, end, set, curLineNumPtr );
+        case 2:
+            return Scan<2>( p, end, set, curLineNumPtr );
+        default:
+            return Scan<4>( p, end, set, curLineNumPtr );
+    }
+}
+
+
 const char* XMLUtil::writeBoolTrue  = "true";
 const char* XMLUtil::writeBoolFalse = "false";
 
@@ -1966,6 +2242,7 @@ XMLDocument::XMLDocument( bool processEntities, Whitespace whitespaceMode ) :
     _whitespaceMode( whitespaceMode ),
     _errorLineNum( 0 ),
     _charBuffer( 0 ),
+    _ownsCharBuffer( true ),
     _parseCurLineNum( 0 )
 {
     // avoid VC++ C4355 warning about 'this' in initializer list (C4355 is off by default in VS2012+)
@@ -1988,8 +2265,11 @@ void XMLDocument::Clear()
 #endif
     ClearError();
 
-    delete [] _charBuffer;
+    if ( _ownsCharBuffer ) {
+        delete [] _charBuffer;
+    }
     _charBuffer = 0;
+    _ownsCharBuffer = true;
 
 #if 0
     _textPool.Trace( "text" );
@@ -2219,6 +2499,30 @@ XMLError XMLDocument::Parse( const char* p, size_t len )
 }
 
 
+XMLError XMLDocument::ParseInPlace( char* p, size_t len )
+{
+    Clear();
+
+    if ( len == 0 || !p || !*p ) {
+        SetError( XML_ERROR_EMPTY_DOCUMENT, 0, 0, 0 );
+        return _errorID;
+    }
+    TIXMLASSERT( p[len] == 0 );
+    _charBuffer = p;
+    _ownsCharBuffer = false;
+
+    Parse();
+    if ( Error() ) {
+        DeleteChildren();
+        _elementPool.Clear();
+        _attributePool.Clear();
+        _textPool.Clear();
+        _commentPool.Clear();
+    }
+    return _errorID;
+}
+
+
 void XMLDocument::Print( XMLPrinter* streamer ) const
 {
     if ( streamer ) {
@@ -533,12 +533,12 @@ public:
     static const char* SkipWhiteSpace( const char* p, int* curLineNumPtr )	{
         TIXMLASSERT( p );
 
-        while( IsWhiteSpace(*p) ) {
-            if (curLineNumPtr && *p == '\n') {
-                ++(*curLineNumPtr);
-            }
-            ++p;
+        // Most of the time there's no whitespace at all, which isn't worth a vectorized scan. The one below reads
+        // whole aligned blocks around p and the null, see the precondition further down
+        if ( !IsWhiteSpace(*p) ) {
+            return p;
         }
+        p = SkipWhiteSpace( p, 0, curLineNumPtr );
         TIXMLASSERT( p );
         return p;
     }
@@ -546,6 +546,22 @@ public:
         return const_cast<char*>( SkipWhiteSpace( const_cast<const char*>(p), curLineNumPtr ) );
     }
 
+    // Vectorized scanning for the inner loops of the parser. These look at 16 bytes at a time, or 32 if
+    // the cpu has AVX2, which is checked once at startup. They stop at end, or at the terminating null if
+    // end is null. Line feeds that are passed over are counted into curLineNumPtr if it isn't null.
+    //
+    // Precondition: blocks are loaded whole at 16 or 32 byte aligned addresses, so up to 31 bytes in front
+    // of p and behind end (or behind the null when end is null) are read, and then ignored. All of those
+    // bytes have to be readable. An aligned block never crosses a page, so this holds for any buffer that
+    // sits in ordinary mapped memory. It doesn't hold for memory that is guarded more finely than a page,
+    // and tools that check every byte that's read can report these loads.
+    static const char* SkipWhiteSpace( const char* p, const char* end, int* curLineNumPtr );
+    // Finds the first occurrence of ch, the same precondition as SkipWhiteSpace applies
+    static const char* FindChar( const char* p, const char* end, char ch, int* curLineNumPtr = 0 );
+    // Finds the first occurrence of any of the (at most 3) characters in the null terminated chars, the same
+    // precondition as SkipWhiteSpace applies
+    static const char* FindChars( const char* p, const char* end, const char* chars, int* curLineNumPtr = 0 );
+
     // Anything in the high order range of UTF-8 is assumed to not be whitespace. This isn't
     // correct, but simple, and usually works.
     static bool IsWhiteSpace( char p )					{
@@ -1637,6 +1653,16 @@ public:
     */
     XMLError Parse( const char* xml, size_t nBytes=(size_t)(-1) );
 
+    /**
+    	Parse an XML document straight out of a buffer owned by the
+    	caller, without copying it first. TinyXML-2 writes into the
+    	buffer while parsing and while strings are read, so it has to
+    	be writable, xml[nBytes] has to be 0 and the buffer has to stay
+    	alive until the document is cleared or destroyed. A private
+    	(copy on write) memory mapping of a file works well for this.
+    */
+    XMLError ParseInPlace( char* xml, size_t nBytes );
+
     /**
     	Load an XML file from disk.
     	Returns XML_SUCCESS (0) on success, or
@@ -1820,6 +1846,7 @@ private:
     mutable StrPair	_errorStr2;
     int             _errorLineNum;
     char*			_charBuffer;
+    bool			_ownsCharBuffer;
     int				_parseCurLineNum;
 
     MemPoolT< sizeof(XMLElement) >	 _elementPool;
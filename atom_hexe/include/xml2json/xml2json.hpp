@@ -5,14 +5,23 @@
 // Copyright (C) 2013 Alan Zhuang (Cheedoong)	Tencent, Inc.
 
 #include <iostream>
-#include <map>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <cctype>
+#include <cstring>
 
 #include "rapidxml/rapidxml.hpp"
 #include "rapidxml/rapidxml_utils.hpp"
 #include "rapidxml/rapidxml_print.hpp"
 
+// rapidjson only skips whitespace 16 bytes at a time if it's told that it can. SSE2 is always there on x64
+#if !defined(RAPIDJSON_SSE2) && !defined(RAPIDJSON_SSE42) && \
+    (defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+#define RAPIDJSON_SSE2
+#endif
+
 #include "rapidjson/document.h"
 #include "rapidjson/prettywriter.h"
 #include "rapidjson/encodedstream.h"
@@ -38,97 +47,157 @@ static const bool xml2json_numeric_support = false;
 */
 /* [End]   This part is configurable */
 
+/* How the converter treats the xml buffer:
+   xml2json_copy:            the xml is parsed in place and every string is copied into the json document, the buffer
+                             can go away as soon as the document is built
+   xml2json_in_situ:         the xml is parsed in place (entities are decoded and strings terminated) and the json
+                             document points straight into the buffer
+   xml2json_non_destructive: the buffer isn't touched at all and the json document points straight into it, entities
+                             are left the way they are written
+*/
+enum xml2json_mode
+{
+    xml2json_copy,
+    xml2json_in_situ,
+    xml2json_non_destructive
+};
+
+// Where every child name of a node ended up in the node's json object. There is one table per depth so that a
+// node's table survives converting its children, the tables are cleared and reused instead of being allocated
+// for every node
+typedef std::unordered_map<std::string_view, rapidjson::SizeType> xml2json_name_table;
+
+// Everything that is shared while converting a single document
+struct xml2json_context
+{
+    xml2json_context(xml2json_mode mode_, rapidjson::Document::AllocatorType& allocator_) : mode(mode_), allocator(allocator_) {}
+
+    xml2json_mode mode;
+    rapidjson::Document::AllocatorType& allocator;
+    std::vector<xml2json_name_table> names_by_depth;
+    // "@" + name for every attribute name in the document. The keys are kept in the document's allocator, so they
+    // go away together with the document and don't depend on the xml buffer
+    std::unordered_map<std::string_view, std::string_view> attribute_keys;
+};
+
 // Avoided any namespace pollution.
-static bool xml2json_has_digits_only(const char * input, bool *hasDecimal)
+static bool xml2json_has_digits_only(const char * input, size_t size, bool *hasDecimal)
 {
     if (input == nullptr)
         return false;  // treat empty input as a string (probably will be an empty string)
 
-    const char * runPtr = input;
-
     *hasDecimal = false;
 
-    while (*runPtr != '\0')
+    for (size_t i = 0; i < size; i++)
     {
-        if (*runPtr == '.')
+        if (input[i] == '.')
         {
             if (!(*hasDecimal))
                 *hasDecimal = true;
             else
                 return false; // we found two dots - not a number
         }
-        else if (isalpha(*runPtr))
+        else if (isalpha(input[i]))
         {
             return false;
         }
-        runPtr++;
     }
 
     return true;
 }
 
-void xml2json_to_array_form(const char *name, rapidjson::Value &jsvalue, rapidjson::Value &jsvalue_chd, rapidjson::Document::AllocatorType& allocator)
+// Strings from the xml buffer are only copied into the allocator when the json can't point into the buffer
+void xml2json_set_string(rapidjson::Value &jsvalue, const char *str, size_t size, xml2json_context &context)
+{
+    if (context.mode == xml2json_copy)
+        jsvalue.SetString(str, static_cast<rapidjson::SizeType>(size), context.allocator);
+    else
+        jsvalue.SetString(rapidjson::StringRef(str, size));
+}
+
+void xml2json_set_value(rapidjson::Value &jsvalue, const char *str, size_t size, xml2json_context &context)
 {
-    rapidjson::Value jsvalue_target; // target to do some operation
-    rapidjson::Value jn;             // this is a must, partially because of the latest version of rapidjson
-    jn.SetString(name, allocator);
-    jsvalue_target = jsvalue.FindMember(name)->value;
-    if(jsvalue_target.IsArray())
+    bool hasDecimal;
+    if (xml2json_numeric_support == false || xml2json_has_digits_only(str, size, &hasDecimal) == false)
     {
-        jsvalue_target.PushBack(jsvalue_chd, allocator);
-        jsvalue.RemoveMember(name);
-        jsvalue.AddMember(jn, jsvalue_target, allocator);
+        xml2json_set_string(jsvalue, str, size, context);
     }
     else
     {
-        rapidjson::Value jsvalue_array;
-        //jsvalue_array = jsvalue_target;
-        jsvalue_array.SetArray();
-        jsvalue_array.PushBack(jsvalue_target, allocator);
-        jsvalue_array.PushBack(jsvalue_chd, allocator);
-        jsvalue.RemoveMember(name);
-        jsvalue.AddMember(jn, jsvalue_array, allocator);
+        // Without string terminators the number has to be copied out before it can be converted
+        std::string number(str, size);
+        if (hasDecimal)
+        {
+            double value = std::strtod(number.c_str(), nullptr);
+            jsvalue.SetDouble(value);
+        }
+        else
+        {
+            long int value = std::strtol(number.c_str(), nullptr, 0);
+            jsvalue.SetInt(value);
+        }
+    }
+}
+
+// Adds a converted child under its name. The first child with a name becomes a member, the ones after it turn that
+// member into an array or are pushed onto it. The member is found through the table, so grouping the siblings
+// takes a single pass and members are never searched for, removed or added again
+void xml2json_add_child(std::string_view name, rapidjson::Value &jsvalue, rapidjson::Value &jsvalue_chd, xml2json_name_table &names, xml2json_context &context)
+{
+    xml2json_name_table::iterator found = names.find(name);
+    if(found == names.end())
+    {
+        names.emplace(name, jsvalue.MemberCount());
+        rapidjson::Value jn;
+        xml2json_set_string(jn, name.data(), name.size(), context);
+        jsvalue.AddMember(jn, jsvalue_chd, context.allocator);
+        return;
     }
+
+    // Children are never arrays themselves, so an array means the name has been seen more than twice
+    rapidjson::Value &jsvalue_target = (jsvalue.MemberBegin() + found->second)->value;
+    if(!jsvalue_target.IsArray())
+    {
+        rapidjson::Value jsvalue_array(rapidjson::kArrayType);
+        jsvalue_array.PushBack(jsvalue_target, context.allocator);
+        jsvalue_target = jsvalue_array;
+    }
+    jsvalue_target.PushBack(jsvalue_chd, context.allocator);
+}
+
+// The key of an attribute is its name with the prefix in front, every key is only put together the first time
+// its name shows up in a document
+std::string_view xml2json_attribute_key(rapidxml::xml_attribute<> *myattr, xml2json_context &context)
+{
+    std::string_view name(myattr->name(), myattr->name_size());
+    std::unordered_map<std::string_view, std::string_view>::iterator found = context.attribute_keys.find(name);
+    if(found != context.attribute_keys.end())
+        return found->second;
+
+    // The name in the table points into the key itself, the xml buffer it came from can go away
+    const size_t prefix_size = sizeof(xml2json_attribute_name_prefix) - 1;
+    char *key = static_cast<char *>(context.allocator.Malloc(prefix_size + name.size() + 1));
+    std::memcpy(key, xml2json_attribute_name_prefix, prefix_size);
+    std::memcpy(key + prefix_size, name.data(), name.size());
+    key[prefix_size + name.size()] = '\0';
+    std::string_view key_view(key, prefix_size + name.size());
+    return context.attribute_keys.emplace(key_view.substr(prefix_size), key_view).first->second;
 }
 
-void xml2json_add_attributes(rapidxml::xml_node<> *xmlnode, rapidjson::Value &jsvalue, rapidjson::Document::AllocatorType& allocator)
+void xml2json_add_attributes(rapidxml::xml_node<> *xmlnode, rapidjson::Value &jsvalue, xml2json_context &context)
 {
     rapidxml::xml_attribute<> *myattr;
     for(myattr = xmlnode->first_attribute(); myattr; myattr = myattr->next_attribute())
     {
         rapidjson::Value jn, jv;
-        jn.SetString((std::string(xml2json_attribute_name_prefix) + myattr->name()).c_str(), allocator);
-
-        if (xml2json_numeric_support == false)
-        {
-            jv.SetString(myattr->value(), allocator);
-        }
-        else
-        {
-            bool hasDecimal;
-            if (xml2json_has_digits_only(myattr->value(), &hasDecimal) == false)
-            {
-                jv.SetString(myattr->value(), allocator);
-            }
-            else
-            {
-                if (hasDecimal)
-                {
-                    double value = std::strtod(myattr->value(),nullptr);
-                    jv.SetDouble(value);
-                }
-                else
-                {
-                    long int value = std::strtol(myattr->value(), nullptr, 0);
-                    jv.SetInt(value);
-                }
-            }
-        }
-        jsvalue.AddMember(jn, jv, allocator);
+        std::string_view key = xml2json_attribute_key(myattr, context);
+        jn.SetString(rapidjson::StringRef(key.data(), key.size()));
+        xml2json_set_value(jv, myattr->value(), myattr->value_size(), context);
+        jsvalue.AddMember(jn, jv, context.allocator);
     }
 }
 
-void xml2json_traverse_node(rapidxml::xml_node<> *xmlnode, rapidjson::Value &jsvalue, rapidjson::Document::AllocatorType& allocator)
+void xml2json_traverse_node(rapidxml::xml_node<> *xmlnode, rapidjson::Value &jsvalue, size_t depth, xml2json_context &context)
 {
     //cout << "this: " << xmlnode->type() << " name: " << xmlnode->name() << " value: " << xmlnode->value() << endl;
     rapidjson::Value jsvalue_chd;
@@ -141,26 +210,26 @@ void xml2json_traverse_node(rapidxml::xml_node<> *xmlnode, rapidjson::Value &jsv
     if((xmlnode->type() == rapidxml::node_data || xmlnode->type() == rapidxml::node_cdata) && xmlnode->value())
     {
         // case: pure_text
-        jsvalue.SetString(xmlnode->value(), allocator);  // then addmember("#text" , jsvalue, allocator)
+        xml2json_set_string(jsvalue, xmlnode->value(), xmlnode->value_size(), context);  // then addmember("#text" , jsvalue, allocator)
     }
     else if(xmlnode->type() == rapidxml::node_element)
     {
         if(xmlnode->first_attribute())
         {
-            if(xmlnode->first_node() && xmlnode->first_node()->type() == rapidxml::node_data && count_children(xmlnode) == 1)
+            if(xmlnode->first_node() && xmlnode->first_node()->type() == rapidxml::node_data && !xmlnode->first_node()->next_sibling())
             {
                 // case: <e attr="xxx">text</e>
                 rapidjson::Value jn, jv;
-                jn.SetString(xml2json_text_additional_name, allocator);
-                jv.SetString(xmlnode->first_node()->value(), allocator);
-                jsvalue.AddMember(jn, jv, allocator);
-                xml2json_add_attributes(xmlnode, jsvalue, allocator);
+                jn.SetString(rapidjson::StringRef(xml2json_text_additional_name));
+                xml2json_set_string(jv, xmlnode->first_node()->value(), xmlnode->first_node()->value_size(), context);
+                jsvalue.AddMember(jn, jv, context.allocator);
+                xml2json_add_attributes(xmlnode, jsvalue, context);
                 return;
             }
             else
             {
                 // case: <e attr="xxx">...</e>
-                xml2json_add_attributes(xmlnode, jsvalue, allocator);
+                xml2json_add_attributes(xmlnode, jsvalue, context);
             }
         }
         else
@@ -171,67 +240,32 @@ void xml2json_traverse_node(rapidxml::xml_node<> *xmlnode, rapidjson::Value &jsv
                 jsvalue.SetNull();
                 return;
             }
-            else if(xmlnode->first_node()->type() == rapidxml::node_data && count_children(xmlnode) == 1)
+            else if(xmlnode->first_node()->type() == rapidxml::node_data && !xmlnode->first_node()->next_sibling())
             {
                 // case: <e>text</e>
-                if (xml2json_numeric_support == false)
-                {
-                    jsvalue.SetString(rapidjson::StringRef(xmlnode->first_node()->value()), allocator);
-                }
-                else
-                {
-                    bool hasDecimal;
-                    if (xml2json_has_digits_only(xmlnode->first_node()->value(), &hasDecimal) == false)
-                    {
-                        jsvalue.SetString(rapidjson::StringRef(xmlnode->first_node()->value()), allocator);
-                    }
-                    else
-                    {
-                        if (hasDecimal)
-                        {
-                            double value = std::strtod(xmlnode->first_node()->value(), nullptr);
-                            jsvalue.SetDouble(value);
-                        }
-                        else
-                        {
-                            long int value = std::strtol(xmlnode->first_node()->value(), nullptr, 0);
-                            jsvalue.SetInt(value);
-                        }
-                    }
-                }
+                xml2json_set_value(jsvalue, xmlnode->first_node()->value(), xmlnode->first_node()->value_size(), context);
                 return;
             }
         }
         if(xmlnode->first_node())
         {
             // case: complex else...
-            std::map<std::string, int> name_count;
+            if(context.names_by_depth.size() <= depth)
+                context.names_by_depth.resize(depth + 1);
+            context.names_by_depth[depth].clear();
             for(xmlnode_chd = xmlnode->first_node(); xmlnode_chd; xmlnode_chd = xmlnode_chd->next_sibling())
             {
-                std::string current_name;
-                const char *name_ptr = NULL;
-                rapidjson::Value jn, jv;
+                std::string_view current_name;
                 if(xmlnode_chd->type() == rapidxml::node_data || xmlnode_chd->type() == rapidxml::node_cdata)
-                {
                     current_name = xml2json_text_additional_name;
-                    name_count[current_name]++;
-                    jv.SetString(xml2json_text_additional_name, allocator);
-                    name_ptr = jv.GetString();
-                }
                 else if(xmlnode_chd->type() == rapidxml::node_element)
-                {
-                    current_name = xmlnode_chd->name();
-                    name_count[current_name]++;
-                    name_ptr = xmlnode_chd->name();
-                }
-                xml2json_traverse_node(xmlnode_chd, jsvalue_chd, allocator);
-                if(name_count[current_name] > 1 && name_ptr)
-                    xml2json_to_array_form(name_ptr, jsvalue, jsvalue_chd, allocator);
+                    current_name = std::string_view(xmlnode_chd->name(), xmlnode_chd->name_size());
                 else
-                {
-                    jn.SetString(name_ptr, allocator);
-                    jsvalue.AddMember(jn, jsvalue_chd, allocator);
-                }
+                    continue;
+
+                xml2json_traverse_node(xmlnode_chd, jsvalue_chd, depth + 1, context);
+                // The children can grow the list of tables, so the table has to be looked up again afterwards
+                xml2json_add_child(current_name, jsvalue, jsvalue_chd, context.names_by_depth[depth], context);
             }
         }
     }
@@ -241,33 +275,61 @@ void xml2json_traverse_node(rapidxml::xml_node<> *xmlnode, rapidjson::Value &jsv
     }
 }
 
-std::string xml2json(const char *xml_str)
+// Converts the xml in xml_str into js_doc. Unless the mode is xml2json_copy the document points into xml_str, so
+// the buffer has to stay around (and unchanged) for as long as the document is used. Only xml2json_non_destructive
+// leaves the buffer the way it was
+void xml2json(char *xml_str, rapidjson::Document &js_doc, xml2json_mode mode)
 {
     //file<> fdoc("track_orig.xml"); // could serve another use case
     rapidxml::xml_document<> *xml_doc = new rapidxml::xml_document<>();
-    xml_doc->parse<0> (const_cast<char *>(xml_str));
+    if (mode == xml2json_non_destructive)
+        xml_doc->parse<rapidxml::parse_non_destructive> (xml_str);
+    else
+        xml_doc->parse<0> (xml_str);
 
-    rapidjson::Document js_doc;
     js_doc.SetObject();
-    rapidjson::Document::AllocatorType& allocator = js_doc.GetAllocator();
+    xml2json_context context(mode, js_doc.GetAllocator());
 
     rapidxml::xml_node<> *xmlnode_chd;
 
     for(xmlnode_chd = xml_doc->first_node(); xmlnode_chd; xmlnode_chd = xmlnode_chd->next_sibling())
     {
-        rapidjson::Value jsvalue_chd;
+        rapidjson::Value jsvalue_chd, jsvalue_name;
         jsvalue_chd.SetObject();
-        //rapidjson::Value jsvalue_name(xmlnode_chd->name(), allocator);
-        //js_doc.AddMember(jsvalue_name, jsvalue_chd, allocator);
-        xml2json_traverse_node(xmlnode_chd, jsvalue_chd, allocator);
-        js_doc.AddMember(rapidjson::StringRef(xmlnode_chd->name()), jsvalue_chd, allocator);
+        xml2json_traverse_node(xmlnode_chd, jsvalue_chd, 0, context);
+        xml2json_set_string(jsvalue_name, xmlnode_chd->name(), xmlnode_chd->name_size(), context);
+        js_doc.AddMember(jsvalue_name, jsvalue_chd, context.allocator);
     }
+    delete xml_doc;
+}
+
+// The json is written out before this returns, so the document can always point into the buffer. Parsing in place
+// (xml2json_copy or xml2json_in_situ) changes xml_str, so it has to be asked for with a buffer that can be changed
+std::string xml2json(char *xml_str, xml2json_mode mode)
+{
+    rapidjson::Document js_doc;
+    xml2json(xml_str, js_doc, mode);
 
     rapidjson::StringBuffer buffer;
     rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
     js_doc.Accept(writer);
-    delete xml_doc;
     return buffer.GetString();
 }
 
+// Leaves xml_str the way it was. The xml is parsed in place inside of a copy, so entities are still decoded like
+// they are with the other modes
+std::string xml2json(const char *xml_str)
+{
+    std::vector<char> xml(xml_str, xml_str + std::char_traits<char>::length(xml_str) + 1);
+    return xml2json(xml.data(), xml2json_in_situ);
+}
+
+// Parses the json that came out of xml2json right inside of its own buffer, the strings in js_doc point into
+// json_str instead of being copied a second time. json_str is changed by this and has to outlive js_doc
+bool xml2json_parse_insitu(std::string &json_str, rapidjson::Document &js_doc)
+{
+    js_doc.ParseInsitu(&json_str[0]);
+    return !js_doc.HasParseError();
+}
+
 #endif
@@ -0,0 +1,144 @@
+#include "cache.h"
+#include "json_writer.h"
+
+#include "rapidjson/writer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+uint64_t HashContents(const char* a_Data, size_t a_Size) {
+  auto hash = uint64_t{14695981039346656037ull};
+  for (auto i = size_t{0}; i < a_Size; i++) {
+    hash ^= static_cast<unsigned char>(a_Data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+bool LoadCache(const std::string& a_FilePath, ExtractionCache& a_Cache) {
+  std::ifstream file{a_FilePath};
+  if (!file.is_open()) {
+    return false;
+  }
+
+  // A cache that can't be read is treated the same as no cache, everything just gets extracted again. That goes
+  // for a cache with the right version but broken contents too, so it's read into a cache of its own and only
+  // handed over once all of it made sense
+  auto loaded = ExtractionCache{};
+
+  // The file is parsed into an arena that's only around while it's being loaded, every script bind is copied out
+  // of it into an arena of its own
+  JsonArena fileArena{};
+  JsonArenaScope fileArenaScope{&fileArena};
+  try {
+    json cache{};
+    file >> cache;
+    if (!cache.is_object() || cache.value("version", 0) != g_CacheVersion) {
+      return false;
+    }
+
+    loaded.indexHash = std::stoull(cache.value("index_hash", std::string{"0"}), nullptr, 16);
+    loaded.typesHash = std::stoull(cache.value("types_hash", std::string{"0"}), nullptr, 16);
+    for (auto& compound : cache.at("index")) {
+      loaded.index.push_back({ compound.at(0).get<std::string>(), compound.at(1).get<std::string>() });
+    }
+
+    auto& compounds = cache.at("compounds");
+    for (auto it = compounds.begin(); it != compounds.end(); ++it) {
+      auto& entry = it.value();
+      auto& cached = loaded.compounds[it.key()];
+
+      cached.hash = std::stoull(entry.at("hash").get<std::string>(), nullptr, 16);
+      cached.result.extracted = entry.at("extracted").get<bool>();
+      cached.result.name = entry.at("name").get<std::string>();
+      cached.result.warnings = entry.at("warnings").get<std::vector<std::string>>();
+      cached.result.unknownTypes = entry.at("unknown_types").get<std::vector<std::string>>();
+
+      // Every script bind gets an arena of its own, the same as one that was just extracted, so a compound that
+      // changes lets go of its memory instead of keeping the whole cache around
+      JsonArenaScope arenaScope{cached.result.arena.Reset()};
+      cached.result.scriptbind = entry.at("scriptbind");
+    }
+  }
+  catch (const std::exception&) {
+    return false;
+  }
+
+  a_Cache = std::move(loaded);
+  return true;
+}
+
+std::string HashToString(uint64_t a_Hash) {
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(a_Hash));
+  return buffer;
+}
+
+// Arrays of plain strings like the warnings of a compound
+template <typename Writer>
+void WriteStrings(const std::vector<std::string>& a_Strings, Writer& a_Writer) {
+  a_Writer.StartArray();
+  for (auto& string : a_Strings) {
+    a_Writer.String(string.c_str(), static_cast<rapidjson::SizeType>(string.size()));
+  }
+  a_Writer.EndArray();
+}
+
+// The cache is streamed out the same way as scriptbinds.json, the script binds are written straight from the
+// compounds instead of being copied into one big json first
+bool SaveCache(const std::string& a_FilePath, const ExtractionCache& a_Cache) {
+  // The compounds are written sorted by file name, so the same compounds always give the same file
+  std::vector<const std::pair<const std::string, CachedCompound>*> compounds{};
+  compounds.reserve(a_Cache.compounds.size());
+  for (auto& compound : a_Cache.compounds) {
+    compounds.push_back(&compound);
+  }
+  std::sort(compounds.begin(), compounds.end(), [](const auto* a_Left, const auto* a_Right) {
+    return a_Left->first < a_Right->first;
+  });
+
+  return WriteJsonFile(a_FilePath, [&](rapidjson::FileWriteStream& a_Stream) {
+    rapidjson::Writer<rapidjson::FileWriteStream> writer{a_Stream};
+    writer.StartObject();
+    writer.Key("version");
+    writer.Int(g_CacheVersion);
+    writer.Key("index_hash");
+    writer.String(HashToString(a_Cache.indexHash).c_str());
+    writer.Key("types_hash");
+    writer.String(HashToString(a_Cache.typesHash).c_str());
+
+    writer.Key("index");
+    writer.StartArray();
+    for (auto& compound : a_Cache.index) {
+      writer.StartArray();
+      writer.String(compound.fileName.c_str(), static_cast<rapidjson::SizeType>(compound.fileName.size()));
+      writer.String(compound.name.c_str(), static_cast<rapidjson::SizeType>(compound.name.size()));
+      writer.EndArray();
+    }
+    writer.EndArray();
+
+    writer.Key("compounds");
+    writer.StartObject();
+    for (auto compound : compounds) {
+      auto& result = compound->second.result;
+      writer.Key(compound->first.c_str(), static_cast<rapidjson::SizeType>(compound->first.size()));
+      writer.StartObject();
+      writer.Key("hash");
+      writer.String(HashToString(compound->second.hash).c_str());
+      writer.Key("extracted");
+      writer.Bool(result.extracted);
+      writer.Key("name");
+      writer.String(result.name.c_str(), static_cast<rapidjson::SizeType>(result.name.size()));
+      writer.Key("scriptbind");
+      WriteJson(result.scriptbind, writer);
+      writer.Key("warnings");
+      WriteStrings(result.warnings, writer);
+      writer.Key("unknown_types");
+      WriteStrings(result.unknownTypes, writer);
+      writer.EndObject();
+    }
+    writer.EndObject();
+    writer.EndObject();
+  });
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "extractor.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Bump this whenever the extraction changes what ends up in a compound so that old caches are thrown away
+const int g_CacheVersion = 6;
+
+// A compound file together with the hash of the contents it was extracted from
+struct CachedCompound {
+  uint64_t hash = 0;
+  CompoundResult result;
+};
+
+// Everything that was extracted during the previous run, keyed by the compound's file name
+struct ExtractionCache {
+  uint64_t indexHash = 0;
+  // The extra Lua types that the compounds were extracted with
+  uint64_t typesHash = 0;
+  std::vector<CompoundRef> index;
+  std::unordered_map<std::string, CachedCompound> compounds;
+};
+
+// FNV-1a hash of a file's contents, only used to find out whether or not a file has changed
+uint64_t HashContents(const char* a_Data, size_t a_Size);
+
+// Hashes are stored as hex strings since not everything that reads json copes with 64 bit numbers
+std::string HashToString(uint64_t a_Hash);
+
+// Loads the cache written by a previous run, a missing or outdated cache is simply left empty
+bool LoadCache(const std::string& a_FilePath, ExtractionCache& a_Cache);
+
+bool SaveCache(const std::string& a_FilePath, const ExtractionCache& a_Cache);
@@ -0,0 +1,736 @@
+#include "extractor.h"
+#include "parallel.h"
+#include "text.h"
+#include "xml_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+using tinyxml2::XMLUtil;
+
+// Prefixs that doxygen uses in the xml output that I want to remove
+const std::string g_EnginePrefix = "hexe::service::scripts::scriptbinds::ScriptBind_";
+const std::string g_GamePrefix = "hexegame::scriptbinds::ScriptBind_";
+
+const JsonKey g_DescriptionKey{"description"};
+const JsonKey g_MethodsKey{"methods"};
+const JsonKey g_ParamsKey{"params"};
+const JsonKey g_RetKey{"ret"};
+const JsonKey g_TypeKey{"type"};
+const JsonKey g_DescKey{"desc"};
+
+// Below this an index isn't split up any further, the threads would spend more time starting than scanning
+constexpr size_t g_MinIndexShardSize = 256 * 1024;
+
+// Gathers all of the text inside of a node, links are replaced by the url that they point to.
+// Descriptions are normalized on the way in so that multi-line comments end up on a single line
+void AppendText(const tinyxml2::XMLNode* a_Node, std::string& a_Text, bool a_Normalize = false) {
+  for (auto child = a_Node->FirstChild(); child; child = child->NextSibling()) {
+    auto text = static_cast<const char*>(nullptr);
+
+    if (child->ToText()) {
+      text = child->Value();
+    }
+    else if (auto element = child->ToElement()) {
+      text = strcmp(element->Name(), "ulink") == 0 ? element->Attribute("url") : nullptr;
+      if (!text) {
+        AppendText(element, a_Text, a_Normalize);
+      }
+    }
+
+    if (text && a_Normalize) {
+      AppendNormalized(text, a_Text);
+    }
+    else if (text) {
+      a_Text += text;
+    }
+  }
+}
+
+// Same as AppendText but for an element that might not be there, a_Text is overwritten
+const std::string& GetText(const tinyxml2::XMLElement* a_Element, std::string& a_Text) {
+  a_Text.clear();
+  if (a_Element) {
+    AppendText(a_Element, a_Text);
+  }
+  return a_Text;
+}
+
+const std::string& GetChildText(const tinyxml2::XMLElement* a_Element, const char* a_ChildName, std::string& a_Text) {
+  return GetText(a_Element->FirstChildElement(a_ChildName), a_Text);
+}
+
+// Grabs the paragraph of a brief or parameter description, returns false if there isn't one
+bool GetDescription(const tinyxml2::XMLElement* a_Description, std::string& a_Text) {
+  auto para = a_Description ? a_Description->FirstChildElement("para") : nullptr;
+  if (!para) {
+    return false;
+  }
+
+  a_Text.clear();
+  AppendText(para, a_Text, true);
+  TrimEnd(a_Text);
+  return true;
+}
+
+// Streamed text was already gathered while reading the file, so it's used as is
+const std::string& GetText(const StreamedText& a_Node, std::string&) {
+  return a_Node.text;
+}
+
+bool GetDescription(const StreamedText& a_Description, std::string& a_Text) {
+  if (!a_Description.found) {
+    return false;
+  }
+
+  a_Text = a_Description.text;
+  return true;
+}
+
+// Translates a C++ type into a Lua type, types that aren't known are written as any and remembered so they can
+// be reported
+const char* GetLuaType(const std::string& a_Type, ExtractScratch& a_Scratch) {
+  auto luaType = a_Scratch.types.Resolve(a_Type);
+  if (luaType == LuaType::Unknown &&
+      std::find(a_Scratch.unknownTypes.begin(), a_Scratch.unknownTypes.end(), a_Type) == a_Scratch.unknownTypes.end()) {
+    a_Scratch.unknownTypes.push_back(a_Type);
+  }
+  return GetLuaTypeName(luaType);
+}
+
+template <typename Node>
+void SetReturnValue(json& a_Rets, const BasicParamItemRecord<Node>& a_Item, ExtractScratch& a_Scratch) {
+  auto luaType = a_Scratch.types.Resolve(GetText(a_Item.name, a_Scratch.text));
+  if (luaType != LuaType::Unknown) {
+    a_Rets.push_back(json::object());
+    auto& ret = a_Rets.back();
+    ret[g_TypeKey] = GetLuaTypeName(luaType);
+    json& desc = ret[g_DescKey] = std::string{};
+    GetDescription(a_Item.description, desc.get_ref<std::string&>());
+  }
+}
+
+bool GetScriptBindName(const char* a_CompoundName, std::string& a_Name) {
+  if (!a_CompoundName) {
+    return false;
+  }
+
+  a_Name = a_CompoundName;
+
+  // Finding both prefixes because the script bind could be either from the engine or from the game
+  auto prefixPos = a_Name.find(g_EnginePrefix);
+  if (prefixPos == std::string::npos) {
+    prefixPos = a_Name.find(g_GamePrefix);
+  }
+  if (prefixPos == std::string::npos) {
+    return false;
+  }
+
+  // Everything up until the first underscore is part of the prefix
+  auto namePos = a_Name.find("_");
+  a_Name.replace(prefixPos, namePos + 1, "");
+  return true;
+}
+
+void ExtractIndex(const tinyxml2::XMLDocument& a_XmlDoc, std::vector<CompoundRef>& a_Compounds) {
+  auto index = a_XmlDoc.FirstChildElement("doxygenindex");
+  if (!index) {
+    return;
+  }
+
+  auto compoundName = std::string{};
+
+  // Iterate over every single compound that doxygen generated and only keep the script binds
+  for (auto compound = index->FirstChildElement("compound"); compound; compound = compound->NextSiblingElement("compound")) {
+    auto refid = compound->Attribute("refid");
+    auto name = std::string{};
+
+    if (refid && GetScriptBindName(GetChildText(compound, "name", compoundName).c_str(), name)) {
+      a_Compounds.push_back({ std::string(refid) + ".xml", std::move(name) });
+    }
+  }
+}
+
+// Doxygen puts the name and description of a documented parameter or return value in a parameteritem
+ParamRecord ReadParam(const tinyxml2::XMLElement* a_Param) {
+  auto param = ParamRecord{};
+  for (auto child = a_Param->FirstChildElement(); child; child = child->NextSiblingElement()) {
+    auto childName = child->Name();
+    if (strcmp(childName, "declname") == 0 && !param.name) {
+      param.name = child;
+    }
+    else if (strcmp(childName, "type") == 0 && !param.type) {
+      param.type = child;
+    }
+  }
+  return param;
+}
+
+ParamItemRecord ReadParamItem(const tinyxml2::XMLElement* a_Item) {
+  auto nameList = a_Item->FirstChildElement("parameternamelist");
+  return { nameList ? nameList->FirstChildElement("parametername") : nullptr, a_Item->FirstChildElement("parameterdescription") };
+}
+
+void ReadMethodRecord(const tinyxml2::XMLElement* a_Member, MethodRecord& a_Record) {
+  a_Record.Clear();
+  auto detailed = static_cast<const tinyxml2::XMLElement*>(nullptr);
+  auto isHandler = true;
+
+  for (auto child = a_Member->FirstChildElement(); child; child = child->NextSiblingElement()) {
+    auto childName = child->Name();
+    if (strcmp(childName, "param") == 0) {
+      // Skip the first parameter since it's always the function handler and that isn't used in the scripts
+      if (!isHandler) {
+        a_Record.params.push_back(ReadParam(child));
+      }
+      isHandler = false;
+    }
+    else if (strcmp(childName, "name") == 0 && !a_Record.name) {
+      a_Record.name = child;
+    }
+    else if (strcmp(childName, "briefdescription") == 0 && !a_Record.brief) {
+      a_Record.brief = child;
+    }
+    else if (strcmp(childName, "detaileddescription") == 0 && !detailed) {
+      detailed = child;
+    }
+  }
+
+  // The descriptions of the parameters and any custom return values are in parameter lists
+  // somewhere inside of the paragraphs of the detailed description
+  auto firstPara = detailed ? detailed->FirstChildElement("para") : nullptr;
+  for (auto para = firstPara; para; para = para->NextSiblingElement("para")) {
+    for (auto list = para->FirstChildElement("parameterlist"); list; list = list->NextSiblingElement("parameterlist")) {
+      auto isParamList = list->Attribute("kind", "param") != nullptr;
+      auto isRetvalList = !isParamList && list->Attribute("kind", "retval");
+      if (!isParamList && !isRetvalList) {
+        continue;
+      }
+
+      a_Record.hasParamList |= isParamList;
+      a_Record.hasRetvalList |= isRetvalList;
+      auto& items = isParamList ? a_Record.paramItems : a_Record.retvals;
+      for (auto item = list->FirstChildElement("parameteritem"); item; item = item->NextSiblingElement("parameteritem")) {
+        items.push_back(ReadParamItem(item));
+      }
+    }
+  }
+}
+
+// Builds the json for a single method out of its record and puts it in the script bind's methods. Everything
+// is written straight into the method's json in place, nothing is put together somewhere else and copied in.
+// The record can come from a parsed document or from streaming the file, the json is the same either way
+template <typename Node>
+void ExtractMethod(const BasicMethodRecord<Node>& a_Record, const std::string& a_ScriptBindName, json& a_Methods,
+                   ExtractScratch& a_Scratch, std::vector<std::string>& a_Warnings) {
+  auto& methodName = GetText(a_Record.name, a_Scratch.methodName);
+
+  // Template for the method json object, a method with the same name as an earlier one replaces it. Every key
+  // goes in before any of them are held on to, adding a key to an object can move the ones that are already there
+  auto& method = a_Methods[methodName] = json::object();
+  method[g_DescriptionKey] = std::string{};
+  method[g_ParamsKey] = json::array();
+  method[g_RetKey] = json::array();
+  auto& params = method[g_ParamsKey];
+  auto& rets = method[g_RetKey];
+  json& description = method[g_DescriptionKey];
+
+  // Find the description of the method
+  if (!GetDescription(a_Record.brief, description.get_ref<std::string&>())) {
+    a_Warnings.push_back("No description on function " + methodName + " for script bind " + a_ScriptBindName);
+  }
+
+  // The parameters are only listed when they are documented, their descriptions are matched up with them by position
+  if (a_Record.hasParamList) {
+    for (auto index = size_t{0}; index < a_Record.params.size(); index++) {
+      auto& param = a_Record.params[index];
+
+      // When putting the methods in the method template I'm using an array so that I can ensure
+      // that the order will stay the same since with a json object the order doesn't usually matter
+      // but in this case it does
+      params.push_back(json::object());
+      auto& paramInfo = params.back()[GetText(param.name, a_Scratch.paramName)];
+      paramInfo[g_TypeKey] = GetLuaType(GetText(param.type, a_Scratch.text), a_Scratch);
+      json& paramDesc = paramInfo[g_DescriptionKey] = std::string{};
+      if (index < a_Record.paramItems.size()) {
+        GetDescription(a_Record.paramItems[index].description, paramDesc.get_ref<std::string&>());
+      }
+    }
+  }
+
+  // A custom return value replaces the void one, only the ones with a type that Lua knows about are kept
+  if (a_Record.hasRetvalList) {
+    for (auto& item : a_Record.retvals) {
+      SetReturnValue(rets, item, a_Scratch);
+    }
+  }
+  else {
+    rets.push_back(json::object());
+    rets.back()[g_TypeKey] = "void";
+    rets.back()[g_DescKey] = "Function doesn't return anything";
+  }
+}
+
+bool ExtractScriptBind(const tinyxml2::XMLDocument& a_XmlDoc, ExtractScratch& a_Scratch, std::string& a_Name,
+                       json& a_ScriptBind, std::vector<std::string>& a_Warnings) {
+  a_Scratch.unknownTypes.clear();
+  auto doxygen = a_XmlDoc.FirstChildElement("doxygen");
+  auto compound = doxygen ? doxygen->FirstChildElement("compounddef") : nullptr;
+  if (!compound) {
+    return false;
+  }
+
+  // Everything that's needed from the compound is picked out of its children in a single pass, the sections
+  // and the list of all members can be long so I don't want to search through them more than once
+  auto compoundName = static_cast<const tinyxml2::XMLElement*>(nullptr);
+  auto brief = static_cast<const tinyxml2::XMLElement*>(nullptr);
+  const tinyxml2::XMLElement* sections[2] = {};
+  for (auto child = compound->FirstChildElement(); child; child = child->NextSiblingElement()) {
+    auto childName = child->Name();
+    if (strcmp(childName, "sectiondef") == 0 && !sections[1]) {
+      sections[sections[0] ? 1 : 0] = child;
+    }
+    else if (strcmp(childName, "compoundname") == 0 && !compoundName) {
+      compoundName = child;
+    }
+    else if (strcmp(childName, "briefdescription") == 0 && !brief) {
+      brief = child;
+    }
+  }
+
+  if (!GetScriptBindName(GetText(compoundName, a_Scratch.text).c_str(), a_Name)) {
+    return false;
+  }
+
+  a_ScriptBind = json::object();
+  a_ScriptBind[g_DescriptionKey] = std::string{};
+  a_ScriptBind[g_MethodsKey] = json::object();
+  auto& methods = a_ScriptBind[g_MethodsKey];
+  auto& description = a_ScriptBind[g_DescriptionKey];
+
+  // Find the description of the script bind
+  if (!GetDescription(brief, description.get_ref<std::string&>())) {
+    a_Warnings.push_back("No description on script bind " + a_Name);
+  }
+
+  // When there is more than one section the methods are in the second one
+  auto section = sections[1] ? sections[1] : sections[0];
+
+  // The first member is always the constructor of the script bind, so a section with only
+  // one member doesn't have any methods
+  auto member = section ? section->FirstChildElement("memberdef") : nullptr;
+  member = member ? member->NextSiblingElement("memberdef") : nullptr;
+
+  // Iterate over every one of the methods found for the script bind and grab it's information
+  for (; member; member = member->NextSiblingElement("memberdef")) {
+    ReadMethodRecord(member, a_Scratch.method);
+    ExtractMethod(a_Scratch.method, a_Name, methods, a_Scratch, a_Warnings);
+  }
+
+  return true;
+}
+
+// Reads the text of the element that was just started up until its end, the streamed version of AppendText
+void StreamText(XmlReader& a_Reader, std::string& a_Text, bool a_Normalize = false) {
+  for (auto token = a_Reader.Next(); token == XmlReader::Token::Text || token == XmlReader::Token::StartElement;
+       token = a_Reader.Next()) {
+    if (token == XmlReader::Token::Text) {
+      a_Reader.AppendText(a_Text, a_Normalize);
+      continue;
+    }
+
+    auto url = std::string_view{};
+    if (a_Reader.Name() == "ulink" && a_Reader.FindAttribute("url", url)) {
+      XmlReader::AppendDecoded(url, a_Text, a_Normalize);
+      a_Reader.SkipElement();
+    }
+    else {
+      StreamText(a_Reader, a_Text, a_Normalize);
+    }
+  }
+}
+
+void StreamText(XmlReader& a_Reader, StreamedText& a_Node) {
+  a_Node.text.clear();
+  a_Node.found = true;
+  StreamText(a_Reader, a_Node.text);
+}
+
+// Only the first paragraph of a description is kept, the same one GetDescription grabs
+void StreamDescription(XmlReader& a_Reader, StreamedText& a_Description) {
+  a_Description.text.clear();
+  a_Description.found = false;
+
+  while (a_Reader.NextChild()) {
+    if (a_Reader.Name() == "para" && !a_Description.found) {
+      a_Description.found = true;
+      StreamText(a_Reader, a_Description.text, true);
+      TrimEnd(a_Description.text);
+    }
+    else {
+      a_Reader.SkipElement();
+    }
+  }
+}
+
+void StreamParam(XmlReader& a_Reader, BasicParamRecord<StreamedText>& a_Param) {
+  while (a_Reader.NextChild()) {
+    if (a_Reader.Name() == "declname" && !a_Param.name.found) {
+      StreamText(a_Reader, a_Param.name);
+    }
+    else if (a_Reader.Name() == "type" && !a_Param.type.found) {
+      StreamText(a_Reader, a_Param.type);
+    }
+    else {
+      a_Reader.SkipElement();
+    }
+  }
+}
+
+void StreamParamItem(XmlReader& a_Reader, BasicParamItemRecord<StreamedText>& a_Item) {
+  auto hasNameList = false;
+  auto hasDescription = false;
+
+  while (a_Reader.NextChild()) {
+    if (a_Reader.Name() == "parameternamelist" && !hasNameList) {
+      hasNameList = true;
+      while (a_Reader.NextChild()) {
+        if (a_Reader.Name() == "parametername" && !a_Item.name.found) {
+          StreamText(a_Reader, a_Item.name);
+        }
+        else {
+          a_Reader.SkipElement();
+        }
+      }
+    }
+    else if (a_Reader.Name() == "parameterdescription" && !hasDescription) {
+      hasDescription = true;
+      StreamDescription(a_Reader, a_Item.description);
+    }
+    else {
+      a_Reader.SkipElement();
+    }
+  }
+}
+
+// The parameter lists are in the paragraphs of the detailed description, the same ones ReadMethodRecord looks in
+void StreamDetailedDescription(XmlReader& a_Reader, StreamedMethodRecord& a_Record) {
+  while (a_Reader.NextChild()) {
+    if (a_Reader.Name() != "para") {
+      a_Reader.SkipElement();
+      continue;
+    }
+
+    while (a_Reader.NextChild()) {
+      auto kind = std::string_view{};
+      auto hasKind = a_Reader.Name() == "parameterlist" && a_Reader.FindAttribute("kind", kind);
+      auto isParamList = hasKind && kind == "param";
+      auto isRetvalList = hasKind && kind == "retval";
+      if (!isParamList && !isRetvalList) {
+        a_Reader.SkipElement();
+        continue;
+      }
+
+      a_Record.hasParamList |= isParamList;
+      a_Record.hasRetvalList |= isRetvalList;
+      auto& items = isParamList ? a_Record.paramItems : a_Record.retvals;
+      while (a_Reader.NextChild()) {
+        if (a_Reader.Name() == "parameteritem") {
+          items.emplace_back();
+          StreamParamItem(a_Reader, items.back());
+        }
+        else {
+          a_Reader.SkipElement();
+        }
+      }
+    }
+  }
+}
+
+// The streamed version of ReadMethodRecord, the memberdef has just been started and is read up until its end
+void StreamMethodRecord(XmlReader& a_Reader, StreamedMethodRecord& a_Record) {
+  a_Record.Clear();
+  auto hasName = false;
+  auto hasBrief = false;
+  auto hasDetailed = false;
+  auto isHandler = true;
+
+  while (a_Reader.NextChild()) {
+    auto childName = a_Reader.Name();
+    if (childName == "param") {
+      // Skip the first parameter since it's always the function handler and that isn't used in the scripts
+      if (isHandler) {
+        a_Reader.SkipElement();
+      }
+      else {
+        a_Record.params.emplace_back();
+        StreamParam(a_Reader, a_Record.params.back());
+      }
+      isHandler = false;
+    }
+    else if (childName == "name" && !hasName) {
+      hasName = true;
+      StreamText(a_Reader, a_Record.name);
+    }
+    else if (childName == "briefdescription" && !hasBrief) {
+      hasBrief = true;
+      StreamDescription(a_Reader, a_Record.brief);
+    }
+    else if (childName == "detaileddescription" && !hasDetailed) {
+      hasDetailed = true;
+      StreamDetailedDescription(a_Reader, a_Record);
+    }
+    else {
+      a_Reader.SkipElement();
+    }
+  }
+}
+
+// Reads the compound in index.xml that was just started and adds it if it's a script bind
+void StreamCompoundRef(XmlReader& a_Reader, std::string& a_CompoundName, std::string& a_Refid,
+                       std::vector<CompoundRef>& a_Compounds) {
+  auto refidValue = std::string_view{};
+  if (!a_Reader.FindAttribute("refid", refidValue)) {
+    a_Reader.SkipElement();
+    return;
+  }
+
+  a_Refid.clear();
+  XmlReader::AppendDecoded(refidValue, a_Refid);
+  auto hasName = false;
+  a_CompoundName.clear();
+  while (a_Reader.NextChild()) {
+    if (a_Reader.Name() == "name" && !hasName) {
+      hasName = true;
+      StreamText(a_Reader, a_CompoundName);
+    }
+    else {
+      a_Reader.SkipElement();
+    }
+  }
+
+  auto name = std::string{};
+  if (GetScriptBindName(a_CompoundName.c_str(), name)) {
+    a_Compounds.push_back({ a_Refid + ".xml", std::move(name) });
+  }
+}
+
+void StreamIndex(const char* a_Data, size_t a_Size, std::vector<CompoundRef>& a_Compounds, tinyxml2::XMLError& a_Error) {
+  XmlReader reader{a_Data, a_Size};
+  auto firstCompound = a_Compounds.size();
+  auto hasIndex = false;
+  auto compoundName = std::string{};
+  auto refid = std::string{};
+
+  while (reader.NextChild()) {
+    if (reader.Name() != "doxygenindex" || hasIndex) {
+      reader.SkipElement();
+      continue;
+    }
+
+    // Iterate over every single compound that doxygen generated and only keep the script binds
+    hasIndex = true;
+    while (reader.NextChild()) {
+      if (reader.Name() != "compound") {
+        reader.SkipElement();
+        continue;
+      }
+      StreamCompoundRef(reader, compoundName, refid, a_Compounds);
+    }
+  }
+
+  // A broken index doesn't list anything, the same as when the document couldn't be parsed
+  a_Error = reader.Error();
+  if (a_Error != tinyxml2::XML_SUCCESS) {
+    a_Compounds.resize(firstCompound);
+  }
+}
+
+// A piece of index.xml that one thread scans, it starts at a compound and ends right in front of the next piece
+struct IndexShard {
+  const char* begin = nullptr;
+  const char* end = nullptr;
+  std::vector<CompoundRef> compounds;
+  bool scanned = false;
+};
+
+struct IndexShardScratch {
+  std::string compoundName;
+  std::string refid;
+};
+
+// Finds the next compound start tag at or after a_From, this doesn't know anything about the xml around it
+const char* FindCompoundTag(const char* a_From, const char* a_End) {
+  auto rest = std::string_view(a_From, static_cast<size_t>(a_End - a_From));
+  for (auto found = rest.find("<compound"); found != std::string_view::npos; found = rest.find("<compound", found + 1)) {
+    auto next = found + 9 < rest.size() ? rest[found + 9] : '\0';
+    if (next == '>' || next == '/' || XMLUtil::IsWhiteSpace(next)) {
+      return a_From + found;
+    }
+  }
+  return a_End;
+}
+
+// Streams a shard, it can't have anything but compounds in it and all of them have to be complete
+void ScanIndexShard(IndexShard& a_Shard, IndexShardScratch& a_Scratch) {
+  XmlReader reader{a_Shard.begin, static_cast<size_t>(a_Shard.end - a_Shard.begin)};
+  while (reader.NextChild()) {
+    if (reader.Name() != "compound") {
+      return;
+    }
+    StreamCompoundRef(reader, a_Scratch.compoundName, a_Scratch.refid, a_Shard.compounds);
+  }
+  a_Shard.scanned = reader.Error() == tinyxml2::XML_SUCCESS && reader.Position() == a_Shard.end;
+}
+
+bool ScanIndex(const char* a_Data, size_t a_Size, unsigned a_ThreadCount, std::vector<CompoundRef>& a_Compounds) {
+  auto end = a_Data + a_Size;
+  auto firstCompound = FindCompoundTag(a_Data, end);
+  auto rest = std::string_view(a_Data, a_Size);
+  auto closeTag = rest.rfind("</doxygenindex");
+  if (firstCompound == end || closeTag == std::string_view::npos || a_Data + closeTag < firstCompound) {
+    return false;
+  }
+
+  // Everything in front of the first compound has to be the start of the index and nothing else, an index
+  // that closes itself right away doesn't have the compounds inside of it
+  XmlReader prolog{a_Data, static_cast<size_t>(firstCompound - a_Data)};
+  if (!prolog.NextChild() || prolog.Name() != "doxygenindex" || prolog.IsSelfClosing() ||
+      XMLUtil::SkipWhiteSpace(prolog.Position(), firstCompound, nullptr) != firstCompound) {
+    return false;
+  }
+
+  // The index has to be closed at the end, tinyxml2 would keep reading anything else that comes after it
+  auto closeEnd = XMLUtil::SkipWhiteSpace(a_Data + closeTag + 14, end, nullptr);
+  if (closeEnd == end || *closeEnd != '>' || XMLUtil::SkipWhiteSpace(closeEnd + 1, end, nullptr) != end) {
+    return false;
+  }
+
+  // The compounds are split up into about as many shards as there are threads, a shard always starts at a
+  // compound so none of them are cut in half. Small indexes aren't worth splitting up
+  auto compoundsEnd = a_Data + closeTag;
+  auto shardCount = std::max<size_t>(std::min<size_t>(a_ThreadCount, a_Size / g_MinIndexShardSize), 1);
+  std::vector<IndexShard> shards{};
+  shards.reserve(shardCount);
+  shards.push_back({ firstCompound, compoundsEnd, {}, false });
+  for (auto i = size_t{1}; i < shardCount; i++) {
+    auto from = std::max(a_Data + a_Size * i / shardCount, shards.back().begin + 1);
+    auto start = FindCompoundTag(std::min(from, compoundsEnd), compoundsEnd);
+    if (start == compoundsEnd) {
+      break;
+    }
+    shards.back().end = start;
+    shards.push_back({ start, compoundsEnd, {}, false });
+  }
+
+  ParallelFor<IndexShardScratch>(shards.size(), a_ThreadCount, [&](IndexShardScratch& a_Scratch, size_t a_Index) {
+    ScanIndexShard(shards[a_Index], a_Scratch);
+  });
+
+  // When any of the shards didn't look right the whole file has to be read the regular way
+  if (std::any_of(shards.begin(), shards.end(), [](const IndexShard& a_Shard) { return !a_Shard.scanned; })) {
+    return false;
+  }
+  for (auto& shard : shards) {
+    std::move(shard.compounds.begin(), shard.compounds.end(), std::back_inserter(a_Compounds));
+  }
+  return true;
+}
+
+bool StreamScriptBind(const char* a_Data, size_t a_Size, ExtractScratch& a_Scratch, std::string& a_Name,
+                      json& a_ScriptBind, std::vector<std::string>& a_Warnings, tinyxml2::XMLError& a_Error) {
+  XmlReader reader{a_Data, a_Size};
+  a_Scratch.unknownTypes.clear();
+  auto& methodWarnings = a_Scratch.methodWarnings;
+  methodWarnings.clear();
+  auto hasDoxygen = false;
+  auto hasCompound = false;
+  auto hasCompoundName = false;
+  auto hasBrief = false;
+  auto hasDescription = false;
+  auto isScriptBind = false;
+  auto sectionCount = 0;
+
+  while (reader.NextChild()) {
+    if (reader.Name() != "doxygen" || hasDoxygen) {
+      reader.SkipElement();
+      continue;
+    }
+
+    hasDoxygen = true;
+    while (reader.NextChild()) {
+      if (reader.Name() != "compounddef" || hasCompound) {
+        reader.SkipElement();
+        continue;
+      }
+
+      // Doxygen always puts the compound's name first, so by the time the sections show up it's known
+      // whether this is a script bind and what its methods should be reported under
+      hasCompound = true;
+      while (reader.NextChild()) {
+        auto childName = reader.Name();
+        if (childName == "compoundname" && !hasCompoundName) {
+          hasCompoundName = true;
+          a_Scratch.text.clear();
+          StreamText(reader, a_Scratch.text);
+          isScriptBind = GetScriptBindName(a_Scratch.text.c_str(), a_Name);
+          if (isScriptBind) {
+            a_ScriptBind = json::object();
+            a_ScriptBind[g_DescriptionKey] = std::string{};
+            a_ScriptBind[g_MethodsKey] = json::object();
+          }
+        }
+        else if (childName == "briefdescription" && !hasBrief && isScriptBind) {
+          hasBrief = true;
+          StreamDescription(reader, a_Scratch.streamedMethod.brief);
+          hasDescription = GetDescription(a_Scratch.streamedMethod.brief, a_ScriptBind[g_DescriptionKey].get_ref<std::string&>());
+        }
+        // When there is more than one section the methods are in the second one, so whatever came out of
+        // the first one is thrown away as soon as the second one starts
+        else if (childName == "sectiondef" && sectionCount < 2 && isScriptBind) {
+          auto& methods = a_ScriptBind[g_MethodsKey];
+          if (sectionCount++ > 0) {
+            methods = json::object();
+            methodWarnings.clear();
+          }
+
+          // The first member is always the constructor of the script bind
+          auto isConstructor = true;
+          while (reader.NextChild()) {
+            if (reader.Name() == "memberdef" && !isConstructor) {
+              StreamMethodRecord(reader, a_Scratch.streamedMethod);
+              ExtractMethod(a_Scratch.streamedMethod, a_Name, methods, a_Scratch, methodWarnings);
+            }
+            else {
+              isConstructor = isConstructor && reader.Name() != "memberdef";
+              reader.SkipElement();
+            }
+          }
+        }
+        else {
+          reader.SkipElement();
+        }
+      }
+    }
+  }
+
+  // Nothing comes out of a file that isn't well formed, no matter how far the reader got into it
+  a_Error = reader.Error();
+  if (a_Error != tinyxml2::XML_SUCCESS) {
+    a_Name.clear();
+    a_ScriptBind = json{};
+    return false;
+  }
+
+  // A compound without a name never got the chance to be a script bind
+  if (!isScriptBind) {
+    return false;
+  }
+
+  if (!hasDescription) {
+    a_Warnings.push_back("No description on script bind " + a_Name);
+  }
+  a_Warnings.insert(a_Warnings.end(), std::make_move_iterator(methodWarnings.begin()), std::make_move_iterator(methodWarnings.end()));
+  return true;
+}
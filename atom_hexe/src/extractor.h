@@ -0,0 +1,156 @@
+#pragma once
+
+#include "flat_map.h"
+#include "json_arena.h"
+#include "json_key.h"
+#include "lua_types.h"
+#include "tinyxml2/tinyxml2.h"
+#include "json/json.hpp"
+
+#include <string>
+#include <vector>
+
+// The objects of the json are FlatMaps keyed by JsonKeys, the keys that every script bind has are shared
+template <typename Key, typename T, typename Compare, typename Allocator>
+using JsonKeyFlatMap = FlatMap<JsonKey, T, std::less<JsonKey>, Allocator>;
+
+// The json that the script binds are built out of keeps its objects in a JsonKeyFlatMap instead of a std::map
+// and takes its values out of the arena of the compound it belongs to, build with ATOM_HEXE_STD_MAP_JSON to go
+// back to the default one and compare the two
+#ifdef ATOM_HEXE_STD_MAP_JSON
+using json = nlohmann::json;
+#else
+using pooled_json = nlohmann::basic_json<JsonKeyFlatMap, std::vector, std::string, bool, std::int64_t, std::uint64_t,
+                                         double, PoolAllocator>;
+using json = pooled_json;
+#endif
+
+// The keys that every script bind and method has. They're made once up front, so putting them into an object or
+// looking them up doesn't have to find them among the shared keys every time
+extern const JsonKey g_DescriptionKey;
+extern const JsonKey g_MethodsKey;
+extern const JsonKey g_ParamsKey;
+extern const JsonKey g_RetKey;
+extern const JsonKey g_TypeKey;
+extern const JsonKey g_DescKey;
+
+// A script bind compound that was found in index.xml
+struct CompoundRef {
+  std::string fileName;
+  std::string name;
+};
+
+// Everything that came out of a single compound file
+struct CompoundResult {
+  bool extracted = false;
+  std::string name;
+  // The arena the script bind was extracted into. It has to stay declared in front of scriptbind: members are
+  // destroyed back to front, so the json goes before its arena, and they're moved front to back, so moving a result
+  // swaps the arenas first and the json that gets replaced can still be torn down in the arena it was built in
+  JsonArenaHandle arena;
+  json scriptbind;
+  std::vector<std::string> warnings;
+  // The C++ types that the script bind uses and that aren't in the type table, each one is only listed once
+  std::vector<std::string> unknownTypes;
+};
+
+// Text that was read out of a compound while streaming it. The elements are gone by the time the json is built
+// from a streamed method, so its record holds on to the text instead of pointing at them
+struct StreamedText {
+  std::string text;
+  bool found = false;
+};
+
+// A parameter or return value from one of the parameter lists in a method's detailed description
+template <typename Node>
+struct BasicParamItemRecord {
+  Node name{};
+  Node description{};
+};
+
+// A parameter from a method's signature
+template <typename Node>
+struct BasicParamRecord {
+  Node name{};
+  Node type{};
+};
+
+// Everything the extraction needs from a method's memberdef. The memberdef is gone through once to fill this
+// in and the json is built from the record, instead of searching the xml for the same elements over and over
+template <typename Node>
+struct BasicMethodRecord {
+  Node name{};
+  Node brief{};
+  // The function handler that every method takes first is already left out
+  std::vector<BasicParamRecord<Node>> params;
+  std::vector<BasicParamItemRecord<Node>> paramItems;
+  std::vector<BasicParamItemRecord<Node>> retvals;
+  bool hasParamList = false;
+  bool hasRetvalList = false;
+
+  // Forgets about the last method but keeps the memory of the lists around
+  void Clear() {
+    name = Node{};
+    brief = Node{};
+    params.clear();
+    paramItems.clear();
+    retvals.clear();
+    hasParamList = false;
+    hasRetvalList = false;
+  }
+};
+
+// The records of a parsed document point at its elements, the streamed ones have the text itself
+using ParamItemRecord = BasicParamItemRecord<const tinyxml2::XMLElement*>;
+using ParamRecord = BasicParamRecord<const tinyxml2::XMLElement*>;
+using MethodRecord = BasicMethodRecord<const tinyxml2::XMLElement*>;
+using StreamedMethodRecord = BasicMethodRecord<StreamedText>;
+
+// Fills in a_Record from a method's memberdef
+void ReadMethodRecord(const tinyxml2::XMLElement* a_Member, MethodRecord& a_Record);
+
+// Scratch memory for extracting compounds. Every thread has one that it reuses for each file, the strings
+// only ever grow, so once they fit the biggest compound walking a file doesn't need any new memory for them
+struct ExtractScratch {
+  std::string methodName;
+  std::string paramName;
+  std::string text;
+  MethodRecord method;
+  StreamedMethodRecord streamedMethod;
+  // The methods of a streamed compound are reported after its description, which comes after them in the file
+  std::vector<std::string> methodWarnings;
+  // Lives as long as the scratch does, so every type is only resolved once per thread in a run
+  LuaTypeResolver types;
+  // The unknown types of the compound that is being extracted, the caller takes them over afterwards
+  std::vector<std::string> unknownTypes;
+};
+
+// Removes the doxygen namespace prefix from a compound name, returns false if the compound isn't a script bind
+bool GetScriptBindName(const char* a_CompoundName, std::string& a_Name);
+
+// Walks index.xml and collects every script bind compound in the order doxygen listed them
+void ExtractIndex(const tinyxml2::XMLDocument& a_XmlDoc, std::vector<CompoundRef>& a_Compounds);
+
+// Walks a script bind's compound xml file and fills a_ScriptBind with its description and methods,
+// returns false if the file doesn't describe a script bind. Anything that is missing from the
+// documentation is reported in a_Warnings instead of being printed, so that compounds can be
+// extracted on any thread and still be reported in order
+bool ExtractScriptBind(const tinyxml2::XMLDocument& a_XmlDoc, ExtractScratch& a_Scratch, std::string& a_Name,
+                       json& a_ScriptBind, std::vector<std::string>& a_Warnings);
+
+// The streamed version of ExtractIndex, index.xml is read straight out of a_Data without parsing it into a
+// document first. If the file isn't well formed a_Error says why and no compounds are added
+void StreamIndex(const char* a_Data, size_t a_Size, std::vector<CompoundRef>& a_Compounds, tinyxml2::XMLError& a_Error);
+
+// Streams index.xml on a_ThreadCount threads at once. The compounds are split up into shards that each start at
+// a compound tag and every shard is read by its own XmlReader, the results are put back together in the order
+// doxygen listed them. This only works on an index that looks like the ones doxygen writes, anything it isn't
+// sure about (anything but compounds in the index, a broken compound, something after it) makes it return false without
+// adding anything so the file can be read the regular way
+bool ScanIndex(const char* a_Data, size_t a_Size, unsigned a_ThreadCount, std::vector<CompoundRef>& a_Compounds);
+
+// The streamed version of ExtractScriptBind. Only the method that is being read is kept around, so the memory
+// this needs doesn't grow with the size of the file. If the file isn't well formed a_Error says why and nothing
+// is extracted, just like a document that tinyxml2 couldn't parse
+bool StreamScriptBind(const char* a_Data, size_t a_Size, ExtractScratch& a_Scratch, std::string& a_Name,
+                      json& a_ScriptBind, std::vector<std::string>& a_Warnings, tinyxml2::XMLError& a_Error);
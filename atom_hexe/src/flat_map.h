@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A method object has three keys and most of the others have one or two, so that's how much room an object gets
+// when its first key goes in
+constexpr size_t g_FlatMapInitialCapacity = 4;
+
+// A map that keeps its entries sorted in a single vector instead of a tree. It's meant for the json objects that
+// the script binds are built out of, most of them only have a handful of keys so a whole object fits in one
+// allocation and is searched without chasing pointers. The entries are kept in the same order as std::map keeps
+// them, so anything that walks a json object (like writing it) comes out exactly the same.
+// The member functions are named and behave like the ones of std::map since that's what nlohmann::basic_json
+// expects from its object type. Unlike std::map, adding or removing a key moves the entries after it, so any
+// reference or iterator into the map has to be taken again afterwards
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, T>>>
+class FlatMap {
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  // The keys can't be const since entries are moved around when something is added in front of them
+  using value_type = std::pair<Key, T>;
+  using key_compare = Compare;
+  using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+  using storage_type = std::vector<value_type, allocator_type>;
+  using size_type = typename storage_type::size_type;
+  using difference_type = typename storage_type::difference_type;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using iterator = typename storage_type::iterator;
+  using const_iterator = typename storage_type::const_iterator;
+
+  FlatMap() = default;
+
+  template <typename InputIterator>
+  FlatMap(InputIterator a_First, InputIterator a_Last) {
+    insert(a_First, a_Last);
+  }
+
+  FlatMap(std::initializer_list<value_type> a_Entries) {
+    insert(a_Entries.begin(), a_Entries.end());
+  }
+
+  iterator begin() { return m_Entries.begin(); }
+  const_iterator begin() const { return m_Entries.begin(); }
+  const_iterator cbegin() const { return m_Entries.cbegin(); }
+  iterator end() { return m_Entries.end(); }
+  const_iterator end() const { return m_Entries.end(); }
+  const_iterator cend() const { return m_Entries.cend(); }
+
+  bool empty() const { return m_Entries.empty(); }
+  size_type size() const { return m_Entries.size(); }
+  size_type max_size() const { return m_Entries.max_size(); }
+  void clear() { m_Entries.clear(); }
+  void reserve(size_type a_Count) { m_Entries.reserve(a_Count); }
+
+  iterator find(const Key& a_Key) {
+    auto entry = lower_bound(a_Key);
+    return entry != end() && !m_Compare(a_Key, entry->first) ? entry : end();
+  }
+
+  const_iterator find(const Key& a_Key) const {
+    auto entry = lower_bound(a_Key);
+    return entry != end() && !m_Compare(a_Key, entry->first) ? entry : end();
+  }
+
+  size_type count(const Key& a_Key) const { return find(a_Key) != end() ? 1 : 0; }
+
+  iterator lower_bound(const Key& a_Key) {
+    return begin() + (static_cast<const FlatMap&>(*this).lower_bound(a_Key) - cbegin());
+  }
+
+  // Keys usually come in already sorted (doxygen sorts a lot of things and so does every json file this wrote),
+  // so the last entry is checked first and adding to the end doesn't have to search at all
+  const_iterator lower_bound(const Key& a_Key) const {
+    if (m_Entries.empty() || m_Compare(m_Entries.back().first, a_Key)) {
+      return end();
+    }
+    return std::lower_bound(begin(), end(), a_Key, [this](const value_type& a_Entry, const Key& a_Other) {
+      return m_Compare(a_Entry.first, a_Other);
+    });
+  }
+
+  T& at(const Key& a_Key) {
+    auto entry = find(a_Key);
+    if (entry == end()) {
+      throw std::out_of_range("key not found");
+    }
+    return entry->second;
+  }
+
+  const T& at(const Key& a_Key) const {
+    auto entry = find(a_Key);
+    if (entry == end()) {
+      throw std::out_of_range("key not found");
+    }
+    return entry->second;
+  }
+
+  T& operator[](const Key& a_Key) { return try_emplace(a_Key).first->second; }
+  T& operator[](Key&& a_Key) { return try_emplace(std::move(a_Key)).first->second; }
+
+  template <typename KeyArg, typename... Args>
+  std::pair<iterator, bool> try_emplace(KeyArg&& a_Key, Args&&... a_Args) {
+    // A key of another type is turned into a Key once up front instead of once for the search and once for the entry
+    if constexpr (!std::is_same<std::decay_t<KeyArg>, Key>::value) {
+      return try_emplace(Key(std::forward<KeyArg>(a_Key)), std::forward<Args>(a_Args)...);
+    }
+    else {
+      auto entry = lower_bound(a_Key);
+      if (entry != end() && !m_Compare(a_Key, entry->first)) {
+        return { entry, false };
+      }
+
+      if (m_Entries.capacity() == 0) {
+        m_Entries.reserve(g_FlatMapInitialCapacity);
+        entry = m_Entries.begin();
+      }
+      entry = m_Entries.emplace(entry, std::piecewise_construct, std::forward_as_tuple(std::forward<KeyArg>(a_Key)),
+                                std::forward_as_tuple(std::forward<Args>(a_Args)...));
+      return { entry, true };
+    }
+  }
+
+  template <typename KeyArg, typename Value>
+  std::pair<iterator, bool> emplace(KeyArg&& a_Key, Value&& a_Value) {
+    return try_emplace(std::forward<KeyArg>(a_Key), std::forward<Value>(a_Value));
+  }
+
+  template <typename Pair>
+  std::pair<iterator, bool> emplace(Pair&& a_Entry) {
+    return try_emplace(std::forward<Pair>(a_Entry).first, std::forward<Pair>(a_Entry).second);
+  }
+
+  std::pair<iterator, bool> insert(const value_type& a_Entry) { return try_emplace(a_Entry.first, a_Entry.second); }
+  std::pair<iterator, bool> insert(value_type&& a_Entry) { return try_emplace(std::move(a_Entry.first), std::move(a_Entry.second)); }
+
+  template <typename InputIterator>
+  void insert(InputIterator a_First, InputIterator a_Last) {
+    for (; a_First != a_Last; ++a_First) {
+      try_emplace(a_First->first, a_First->second);
+    }
+  }
+
+  iterator erase(const_iterator a_Position) { return m_Entries.erase(a_Position); }
+  iterator erase(const_iterator a_First, const_iterator a_Last) { return m_Entries.erase(a_First, a_Last); }
+
+  size_type erase(const Key& a_Key) {
+    auto entry = find(a_Key);
+    if (entry == end()) {
+      return 0;
+    }
+    m_Entries.erase(entry);
+    return 1;
+  }
+
+  void swap(FlatMap& a_Other) { m_Entries.swap(a_Other.m_Entries); }
+
+  friend bool operator==(const FlatMap& a_Left, const FlatMap& a_Right) { return a_Left.m_Entries == a_Right.m_Entries; }
+  friend bool operator!=(const FlatMap& a_Left, const FlatMap& a_Right) { return !(a_Left == a_Right); }
+  friend bool operator<(const FlatMap& a_Left, const FlatMap& a_Right) { return a_Left.m_Entries < a_Right.m_Entries; }
+
+private:
+  storage_type m_Entries;
+  Compare m_Compare;
+};
@@ -0,0 +1,288 @@
+#include "generator.h"
+#include "json_output.h"
+#include "lua_types.h"
+#include "mapped_file.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+// Just some error checking when loading an xml file
+void XmlErrorCheck(const tinyxml2::XMLError a_LoadResult, const char* a_XmlFileName, std::vector<std::string>& a_Warnings) {
+  if (a_LoadResult != tinyxml2::XML_SUCCESS) {
+    a_Warnings.push_back(std::string("Couldn't load ") + a_XmlFileName + ". Error " + tinyxml2::XMLDocument::ErrorIDToName(a_LoadResult));
+  }
+}
+
+void PrintWarnings(const std::vector<std::string>& a_Warnings) {
+  for (auto& warning : a_Warnings) {
+    printf("%s\n", warning.c_str());
+  }
+}
+
+std::string JoinPath(const std::string& a_Dir, const std::string& a_FileName) {
+#ifdef _WIN32
+  return a_Dir + "\\" + a_FileName;
+#else
+  return a_Dir + "/" + a_FileName;
+#endif
+}
+
+std::string OutputFileName(const GeneratorSettings& a_Settings) {
+  return a_Settings.shards ? "scriptbinds.manifest.json" : "scriptbinds.json";
+}
+
+// Reads index.xml again if it changed, returns true if the list of script binds has to be rebuilt
+bool UpdateIndex(const GeneratorSettings& a_Settings, ExtractionCache& a_Cache, RunStats& a_Stats) {
+  MappedFile xmlFile{};
+
+  // Mapping the xml file into memory
+  if (!xmlFile.Open(JoinPath(a_Settings.inputDir, "index.xml"), a_Settings.mapFiles)) {
+    printf("Couldn't load index.xml. Error XML_ERROR_FILE_NOT_FOUND\n");
+    a_Cache.indexHash = 0;
+    a_Cache.index.clear();
+    return true;
+  }
+
+  a_Stats.bytesRead += xmlFile.Size();
+  auto indexHash = HashContents(xmlFile.Data(), xmlFile.Size());
+  if (indexHash == a_Cache.indexHash) {
+    return false;
+  }
+
+  a_Cache.indexHash = indexHash;
+  a_Cache.index.clear();
+
+  // A well formed index is scanned on every thread, the slower paths below are only needed for the rest
+  if (ScanIndex(xmlFile.Data(), xmlFile.Size(), a_Settings.threadCount, a_Cache.index)) {
+    return true;
+  }
+
+  std::vector<std::string> indexWarnings{};
+  if (a_Settings.stream) {
+    auto xmlLoadResult = tinyxml2::XML_SUCCESS;
+    StreamIndex(xmlFile.Data(), xmlFile.Size(), a_Cache.index, xmlLoadResult);
+    XmlErrorCheck(xmlLoadResult, "index.xml", indexWarnings);
+    PrintWarnings(indexWarnings);
+    return true;
+  }
+
+  // The document is parsed right out of the mapped pages, so it has to go away before the mapping does
+  tinyxml2::XMLDocument xmlDoc{};
+  tinyxml2::XMLError xmlLoadResult = xmlDoc.ParseInPlace(xmlFile.Data(), xmlFile.Size());
+
+  XmlErrorCheck(xmlLoadResult, "index.xml", indexWarnings);
+  PrintWarnings(indexWarnings);
+
+  // Iterate over every single compound that doxygen generated and filter out all
+  // the useless information that we do not require
+  ExtractIndex(xmlDoc, a_Cache.index);
+  return true;
+}
+
+// Everything a thread needs to extract compounds, it's reset between files instead of being freed so that
+// after the first few files a thread has all of the memory it needs to parse and walk the rest of them
+struct CompoundWorkspace {
+  tinyxml2::XMLDocument xmlDoc;
+  ExtractScratch scratch;
+};
+
+// What a single compound cost, every compound gets its own so the threads don't have to share anything
+struct CompoundStats {
+  StageStats load;
+  StageStats parse;
+  StageStats extraction;
+  uint64_t bytes = 0;
+  bool extracted = false;
+  // The compound hadn't changed and was taken out of the cache as it was
+  bool cached = false;
+};
+
+bool Generate(const GeneratorSettings& a_Settings, GeneratorState& a_State, const std::vector<std::string>* a_ChangedFiles) {
+  StageTimer runTimer{};
+  auto& cache = a_State.cache;
+  auto& stats = a_State.stats;
+  stats = RunStats{};
+  auto isChanged = [&](const std::string& a_FileName) {
+    return !a_ChangedFiles || std::find(a_ChangedFiles->begin(), a_ChangedFiles->end(), a_FileName) != a_ChangedFiles->end();
+  };
+
+  StageTimer indexTimer{};
+  auto indexChanged = isChanged("index.xml") && UpdateIndex(a_Settings, cache, stats);
+  indexTimer.Stop(stats[Stage::IndexLoad]);
+
+  // The types of the parameters depend on the extra Lua types, so when those changed nothing in the cache can be used
+  // Whenever this stays false the cache on disk is still the same as the one in memory and isn't written again.
+  // A new index is the only way for compounds to be forgotten, so that's covered by it as well
+  auto cacheChanged = indexChanged;
+  if (cache.typesHash != LuaTypesHash()) {
+    cache.typesHash = LuaTypesHash();
+    cache.compounds.clear();
+    cacheChanged = true;
+  }
+
+  // Only the compounds that changed or that we haven't seen before have to be looked at
+  std::vector<size_t> toLoad{};
+  for (auto i = size_t{0}; i < cache.index.size(); i++) {
+    if (isChanged(cache.index[i].fileName) || cache.compounds.find(cache.index[i].fileName) == cache.compounds.end()) {
+      toLoad.push_back(i);
+    }
+  }
+
+  // Every script bind is independent of the others, so each file is loaded and extracted on whichever
+  // thread is free with a workspace that belongs to that thread
+  std::vector<CachedCompound> loaded(toLoad.size());
+  std::vector<CompoundStats> compoundStats(toLoad.size());
+
+  ParallelFor<CompoundWorkspace>(toLoad.size(), a_Settings.threadCount, [&](CompoundWorkspace& a_Workspace, size_t a_Index) {
+    auto& xmlDoc = a_Workspace.xmlDoc;
+    auto& compound = cache.index[toLoad[a_Index]];
+    auto& entry = loaded[a_Index];
+    auto& entryStats = compoundStats[a_Index];
+    StageTimer loadTimer{};
+    MappedFile xmlFile{};
+
+    if (!xmlFile.Open(JoinPath(a_Settings.inputDir, compound.fileName), a_Settings.mapFiles)) {
+      entry.result.warnings.push_back("Couldn't load " + compound.fileName + ". Error XML_ERROR_FILE_NOT_FOUND");
+      return;
+    }
+    entry.hash = HashContents(xmlFile.Data(), xmlFile.Size());
+    entryStats.bytes = xmlFile.Size();
+    loadTimer.Stop(entryStats.load);
+
+    // Script binds that haven't changed since they were last extracted are taken straight out of the cache,
+    // each file only shows up once in the index so the cached result can be moved out without any locking
+    auto cached = cache.compounds.find(compound.fileName);
+    if (cached != cache.compounds.end() && cached->second.hash == entry.hash) {
+      entry.result = std::move(cached->second.result);
+      entryStats.cached = true;
+      return;
+    }
+
+    // Everything the script bind is built out of comes from an arena of its own, it's freed all at once together
+    // with the script bind instead of value by value
+    JsonArenaScope arenaScope{entry.result.arena.Reset()};
+
+    // Streaming reads and extracts in one go, so there's no separate parse to time
+    if (a_Settings.stream) {
+      StageTimer extractionTimer{};
+      auto loadResult = tinyxml2::XML_SUCCESS;
+      entry.result.extracted = StreamScriptBind(xmlFile.Data(), xmlFile.Size(), a_Workspace.scratch, entry.result.name,
+                                                entry.result.scriptbind, entry.result.warnings, loadResult);
+      entry.result.unknownTypes = a_Workspace.scratch.unknownTypes;
+      XmlErrorCheck(loadResult, compound.fileName.c_str(), entry.result.warnings);
+      extractionTimer.Stop(entryStats.extraction);
+      entryStats.extracted = true;
+      return;
+    }
+
+    // Parsing straight out of the mapped pages, tinyxml2 doesn't have to copy the file into a buffer of its own
+    StageTimer parseTimer{};
+    auto loadResult = xmlDoc.ParseInPlace(xmlFile.Data(), xmlFile.Size());
+    parseTimer.Stop(entryStats.parse);
+
+    XmlErrorCheck(loadResult, compound.fileName.c_str(), entry.result.warnings);
+
+    StageTimer extractionTimer{};
+    entry.result.extracted = ExtractScriptBind(xmlDoc, a_Workspace.scratch, entry.result.name, entry.result.scriptbind,
+                                               entry.result.warnings);
+    entry.result.unknownTypes = a_Workspace.scratch.unknownTypes;
+    extractionTimer.Stop(entryStats.extraction);
+    entryStats.extracted = true;
+
+    // The document points into the mapping, so it has to let go of it before the file is unmapped. Clearing
+    // only hands the nodes back to the document's pools, the next file on this thread is built out of them
+    xmlDoc.Clear();
+  });
+
+  for (auto i = size_t{0}; i < toLoad.size(); i++) {
+    auto& entryStats = compoundStats[i];
+    stats[Stage::CompoundLoad].Add(entryStats.load);
+    stats[Stage::XmlParse].Add(entryStats.parse);
+    stats[Stage::Extraction].Add(entryStats.extraction);
+    stats.bytesRead += entryStats.bytes;
+    if (entryStats.extracted) {
+      stats.compoundsExtracted++;
+      auto methods = loaded[i].result.scriptbind.find(g_MethodsKey);
+      stats.methods += loaded[i].result.extracted && methods != loaded[i].result.scriptbind.end() ? methods->size() : 0;
+    }
+
+    cacheChanged = cacheChanged || !entryStats.cached;
+    cache.compounds[cache.index[toLoad[i]].fileName] = std::move(loaded[i]);
+  }
+  stats.compounds = toLoad.size();
+
+  // The compounds that took the longest from opening the file until they were extracted
+  std::vector<size_t> byTime(toLoad.size());
+  for (auto i = size_t{0}; i < byTime.size(); i++) {
+    byTime[i] = i;
+  }
+  auto slowestCount = std::min(byTime.size(), g_SlowestCompoundCount);
+  auto compoundSeconds = [&](size_t a_Index) {
+    auto& entryStats = compoundStats[a_Index];
+    return entryStats.load.seconds + entryStats.parse.seconds + entryStats.extraction.seconds;
+  };
+  std::partial_sort(byTime.begin(), byTime.begin() + slowestCount, byTime.end(), [&](size_t a_Left, size_t a_Right) {
+    return compoundSeconds(a_Left) > compoundSeconds(a_Right);
+  });
+  for (auto i = size_t{0}; i < slowestCount; i++) {
+    stats.slowest.push_back({ cache.index[toLoad[byTime[i]]].fileName, compoundSeconds(byTime[i]) });
+  }
+
+  // Forget about the compounds that aren't in the index anymore
+  if (indexChanged) {
+    std::unordered_set<std::string> fileNames{};
+    for (auto& compound : cache.index) {
+      fileNames.insert(compound.fileName);
+    }
+    for (auto it = cache.compounds.begin(); it != cache.compounds.end();) {
+      it = fileNames.count(it->first) ? std::next(it) : cache.compounds.erase(it);
+    }
+  }
+
+  // Warnings are printed in the same order as the index so that they are the same no matter how many
+  // threads were used. When the list of script binds could have changed all of them are reported again.
+  // A type that isn't known is only reported by the first script bind that uses it
+  std::unordered_set<std::string> reportedTypes{};
+  auto printCompoundWarnings = [&](const CompoundResult& a_Result) {
+    PrintWarnings(a_Result.warnings);
+    for (auto& type : a_Result.unknownTypes) {
+      if (reportedTypes.insert(type).second) {
+        printf("Unknown C++ type %s, it's written as any\n", type.c_str());
+      }
+    }
+  };
+  if (indexChanged || !a_ChangedFiles) {
+    for (auto& compound : cache.index) {
+      printCompoundWarnings(cache.compounds[compound.fileName].result);
+    }
+  }
+  else {
+    for (auto index : toLoad) {
+      printCompoundWarnings(cache.compounds[cache.index[index].fileName].result);
+    }
+  }
+
+  if (a_Settings.useCache && cacheChanged) {
+    StageTimer cacheTimer{};
+    auto cachePath = JoinPath(a_Settings.outputDir, ".atom_hexe_cache");
+    if (!SaveCache(cachePath, cache)) {
+      printf("Couldn't write the cache to %s\n", cachePath.c_str());
+    }
+    cacheTimer.Stop(stats[Stage::CacheSave]);
+  }
+
+  // Serialize the data by streaming every script bind straight into the json file, or into shards of their own
+  StageTimer outputTimer{};
+  auto written = a_Settings.shards ? WriteScriptBindShards(a_Settings.outputDir, cache, a_Settings.compact, stats.shardsWritten)
+                                   : WriteScriptBinds(JoinPath(a_Settings.outputDir, "scriptbinds.json"), cache, a_Settings.compact);
+  if (a_Settings.writeIndex && !WriteScriptBindIndex(JoinPath(a_Settings.outputDir, "scriptbinds.index.json"), cache)) {
+    printf("Couldn't write %s\n", JoinPath(a_Settings.outputDir, "scriptbinds.index.json").c_str());
+  }
+  outputTimer.Stop(stats[Stage::Output]);
+
+  auto run = StageStats{};
+  runTimer.Stop(run);
+  stats.wallSeconds = run.seconds;
+  return written;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "cache.h"
+#include "stats.h"
+
+#include <string>
+#include <vector>
+
+// Everything that was passed to the command that changes how scriptbinds.json is generated
+struct GeneratorSettings {
+  std::string inputDir;
+  std::string outputDir;
+  unsigned threadCount = 1;
+  bool useCache = true;
+  bool compact = false;
+  // Also writes scriptbinds.index.json, the script binds laid out for the editor's autocomplete
+  bool writeIndex = false;
+  // Writes every script bind into its own file with a manifest next to them instead of scriptbinds.json
+  bool shards = false;
+  // Streams the xml files instead of parsing them into documents, the output is exactly the same
+  bool stream = false;
+  // Reads the xml files into memory instead of mapping them. In watch mode doxygen can rewrite a file while it's
+  // being read, and a mapped file that is cut short kills the process
+  bool mapFiles = true;
+};
+
+// What the generator knows about the doxygen output, this sticks around between runs in watch mode so
+// that only the files that changed have to be extracted again
+struct GeneratorState {
+  ExtractionCache cache;
+  // What the last run measured, it's thrown away at the start of every run
+  RunStats stats;
+};
+
+// Puts a directory and a file name together using the separator of the platform
+std::string JoinPath(const std::string& a_Dir, const std::string& a_FileName);
+
+// The file that the editor loads first, scriptbinds.json or the manifest of the shards
+std::string OutputFileName(const GeneratorSettings& a_Settings);
+
+// Extracts the script binds and writes scriptbinds.json. When a_ChangedFiles is null every file is checked,
+// otherwise only the files in it (plus any compound that isn't known yet) are read again
+bool Generate(const GeneratorSettings& a_Settings, GeneratorState& a_State, const std::vector<std::string>* a_ChangedFiles);
@@ -0,0 +1,37 @@
+#include "json_arena.h"
+
+#include <algorithm>
+
+// The first block fits a script bind with a couple of methods and the ones after it are twice as big. Every
+// compound has its own arena and whatever is left at the end of its last block is wasted, so they stay small
+constexpr size_t g_FirstArenaBlockSize = 4 * 1024;
+constexpr size_t g_ArenaBlockSize = 8 * 1024;
+
+thread_local JsonArena* g_CurrentJsonArena = nullptr;
+
+void* JsonArena::Allocate(size_t a_Size) {
+  a_Size = (a_Size + g_JsonArenaAlignment - 1) / g_JsonArenaAlignment * g_JsonArenaAlignment;
+  if (static_cast<size_t>(m_End - m_Next) < a_Size) {
+    auto blockSize = std::max(m_Blocks.empty() ? g_FirstArenaBlockSize : g_ArenaBlockSize, a_Size);
+    m_Blocks.emplace_back(new char[blockSize]);
+    m_Next = m_Blocks.back().get();
+    m_End = m_Next + blockSize;
+    m_Capacity += blockSize;
+  }
+
+  auto memory = m_Next;
+  m_Next += a_Size;
+  return memory;
+}
+
+JsonArena* JsonArena::Current() {
+  return g_CurrentJsonArena;
+}
+
+JsonArenaScope::JsonArenaScope(JsonArena* a_Arena) : m_Previous(g_CurrentJsonArena) {
+  g_CurrentJsonArena = a_Arena;
+}
+
+JsonArenaScope::~JsonArenaScope() {
+  g_CurrentJsonArena = m_Previous;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Memory for the json of a single compound. Everything is handed out of a few blocks one after the other and
+// nothing is given back until the whole arena goes away, which is when the compound's json goes away as well.
+// An arena is only ever filled by one thread at a time
+class JsonArena {
+public:
+  JsonArena() = default;
+  JsonArena(const JsonArena&) = delete;
+  JsonArena& operator=(const JsonArena&) = delete;
+
+  void* Allocate(size_t a_Size);
+
+  // How much memory the arena took from the heap, the unused end of its last block included
+  size_t Capacity() const { return m_Capacity; }
+
+  // The arena that the json allocations on the calling thread go to, null when they go to the heap
+  static JsonArena* Current();
+
+private:
+  std::vector<std::unique_ptr<char[]>> m_Blocks;
+  char* m_Next = nullptr;
+  char* m_End = nullptr;
+  size_t m_Capacity = 0;
+};
+
+// Sends the json allocations of the calling thread to a_Arena for as long as the scope is around
+class JsonArenaScope {
+public:
+  explicit JsonArenaScope(JsonArena* a_Arena);
+  ~JsonArenaScope();
+
+  JsonArenaScope(const JsonArenaScope&) = delete;
+  JsonArenaScope& operator=(const JsonArenaScope&) = delete;
+
+private:
+  JsonArena* m_Previous;
+};
+
+// Keeps the arena that a json tree was built in alive. It has to be declared in front of the json it belongs to,
+// so that the json is destroyed first. Moving one into another swaps them instead of letting go of the old arena
+// right away, that way the json that is moved in right after it can still tear down its old tree
+class JsonArenaHandle {
+public:
+  JsonArenaHandle() = default;
+  JsonArenaHandle(JsonArenaHandle&&) = default;
+  JsonArenaHandle(const JsonArenaHandle&) = default;
+  JsonArenaHandle& operator=(const JsonArenaHandle&) = default;
+
+  JsonArenaHandle& operator=(JsonArenaHandle&& a_Other) noexcept {
+    std::swap(m_Arena, a_Other.m_Arena);
+    return *this;
+  }
+
+  // Starts over with an arena of its own, the json that used the old one has to be gone already
+  JsonArena* Reset() {
+    m_Arena = std::make_shared<JsonArena>();
+    return m_Arena.get();
+  }
+
+  JsonArena* Get() const { return m_Arena.get(); }
+
+private:
+  std::shared_ptr<JsonArena> m_Arena;
+};
+
+// The json is made out of pointers, sizes and 64 bit numbers, so nothing that goes into an arena has to be
+// aligned any further than this
+constexpr size_t g_JsonArenaAlignment = 8;
+
+// Allocator for the json tree. nlohmann::basic_json creates a new allocator every time it allocates something,
+// so this can't carry the arena around and takes whichever one is current on the thread instead. Every json that
+// uses it has to be built inside a JsonArenaScope, there's no heap to fall back to. That way nothing has to
+// remember where its memory came from, all of it is given back at once when the arena goes away
+template <typename T>
+class PoolAllocator {
+public:
+  using value_type = T;
+
+  PoolAllocator() = default;
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>&) {}
+
+  T* allocate(size_t a_Count) {
+    static_assert(alignof(T) <= g_JsonArenaAlignment, "The json arena doesn't align this type far enough");
+    auto arena = JsonArena::Current();
+    assert(arena && "The json has to be built inside a JsonArenaScope");
+    if (!arena) {
+      throw std::bad_alloc{};
+    }
+    return static_cast<T*>(arena->Allocate(a_Count * sizeof(T)));
+  }
+
+  void deallocate(T*, size_t) {}
+
+  // nlohmann::basic_json constructs and destroys through the allocator itself
+  template <typename U, typename... Args>
+  void construct(U* a_Pointer, Args&&... a_Args) {
+    ::new (static_cast<void*>(a_Pointer)) U(std::forward<Args>(a_Args)...);
+  }
+
+  template <typename U>
+  void destroy(U* a_Pointer) {
+    a_Pointer->~U();
+  }
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U>&) const { return true; }
+
+  template <typename U>
+  bool operator!=(const PoolAllocator<U>&) const { return false; }
+};
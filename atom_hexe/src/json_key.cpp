@@ -0,0 +1,99 @@
+#include "json_key.h"
+#include "json_arena.h"
+
+#include <utility>
+
+// The keys that every script bind is made of. These never change, so they can be shared between every thread
+// without a lock
+constexpr std::string_view g_SharedDescription = "description";
+constexpr std::string_view g_SharedMethods = "methods";
+constexpr std::string_view g_SharedParams = "params";
+constexpr std::string_view g_SharedRet = "ret";
+constexpr std::string_view g_SharedType = "type";
+constexpr std::string_view g_SharedDesc = "desc";
+
+// The shared keys all have a different length except for type and desc, so a key only ever has to be compared
+// to one of them
+const std::string_view* FindSharedKey(std::string_view a_String) {
+  switch (a_String.size()) {
+    case 3:
+      return &g_SharedRet;
+    case 4:
+      return a_String[0] == 't' ? &g_SharedType : &g_SharedDesc;
+    case 6:
+      return &g_SharedParams;
+    case 7:
+      return &g_SharedMethods;
+    case 11:
+      return &g_SharedDescription;
+    default:
+      return nullptr;
+  }
+}
+
+JsonKey::JsonKey(std::string_view a_String) {
+  auto shared = FindSharedKey(a_String);
+  if (shared && *shared == a_String) {
+    m_Data = shared->data();
+    m_Size = static_cast<uint32_t>(shared->size());
+    return;
+  }
+  Copy(a_String);
+}
+
+JsonKey::JsonKey(const JsonKey& a_Other) {
+  if (a_Other.m_Storage != Storage::Shared) {
+    Copy(a_Other);
+  }
+  else {
+    m_Data = a_Other.m_Data;
+    m_Size = a_Other.m_Size;
+  }
+}
+
+JsonKey::JsonKey(JsonKey&& a_Other) noexcept
+    : m_Data(a_Other.m_Data), m_Size(a_Other.m_Size), m_Storage(a_Other.m_Storage) {
+  a_Other.m_Data = "";
+  a_Other.m_Size = 0;
+  a_Other.m_Storage = Storage::Shared;
+}
+
+JsonKey& JsonKey::operator=(const JsonKey& a_Other) {
+  if (this != &a_Other) {
+    *this = JsonKey(a_Other);
+  }
+  return *this;
+}
+
+JsonKey& JsonKey::operator=(JsonKey&& a_Other) noexcept {
+  std::swap(m_Data, a_Other.m_Data);
+  std::swap(m_Size, a_Other.m_Size);
+  std::swap(m_Storage, a_Other.m_Storage);
+  return *this;
+}
+
+JsonKey::~JsonKey() {
+  Release();
+}
+
+// The copy goes wherever the json that it's a key of goes, which is the arena that's current on the thread. Keys
+// that are only made to look something up are made outside of any arena, those are copied onto the heap
+void JsonKey::Copy(std::string_view a_String) {
+  if (a_String.empty()) {
+    return;
+  }
+
+  auto arena = JsonArena::Current();
+  auto data = static_cast<char*>(arena ? arena->Allocate(a_String.size() + 1) : ::operator new(a_String.size() + 1));
+  memcpy(data, a_String.data(), a_String.size());
+  data[a_String.size()] = '\0';
+  m_Data = data;
+  m_Size = static_cast<uint32_t>(a_String.size());
+  m_Storage = arena ? Storage::Arena : Storage::Heap;
+}
+
+void JsonKey::Release() {
+  if (m_Storage == Storage::Heap) {
+    ::operator delete(const_cast<char*>(m_Data));
+  }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// A key of the json objects. The keys that every script bind is made of ("description", "methods" and so on) are
+// only stored once for the whole program and a key like that just points at it, the "description" of every method
+// is the same string instead of a copy of its own. Any other key, like the name of a method or a param, keeps a
+// copy that comes out of the arena of the json it's in (or the heap outside of one) and goes away along with it,
+// so a long running --watch doesn't hold on to the names of methods that are long gone. Only keys are shared, the
+// values are strings that every json value owns
+class JsonKey {
+public:
+  JsonKey() = default;
+  JsonKey(std::string_view a_String);
+  JsonKey(const std::string& a_String) : JsonKey(std::string_view(a_String)) {}
+  JsonKey(const char* a_String) : JsonKey(std::string_view(a_String)) {}
+
+  JsonKey(const JsonKey& a_Other);
+  JsonKey(JsonKey&& a_Other) noexcept;
+  JsonKey& operator=(const JsonKey& a_Other);
+  JsonKey& operator=(JsonKey&& a_Other) noexcept;
+  ~JsonKey();
+
+  std::string str() const { return std::string(m_Data, m_Size); }
+  operator std::string() const { return str(); }
+  operator std::string_view() const { return std::string_view(m_Data, m_Size); }
+
+  const char* c_str() const { return m_Data; }
+  size_t size() const { return m_Size; }
+  bool empty() const { return m_Size == 0; }
+
+  // Two of the shared keys are the same exactly when they point at the same place, the rest compare characters
+  friend bool operator==(const JsonKey& a_Left, const JsonKey& a_Right) {
+    return a_Left.m_Data == a_Right.m_Data ||
+           (a_Left.m_Size == a_Right.m_Size && memcmp(a_Left.m_Data, a_Right.m_Data, a_Left.m_Size) == 0);
+  }
+
+  friend bool operator!=(const JsonKey& a_Left, const JsonKey& a_Right) {
+    return !(a_Left == a_Right);
+  }
+
+  // Sorted by the characters like std::string is, so an object comes out in the same order either way
+  friend bool operator<(const JsonKey& a_Left, const JsonKey& a_Right) {
+    return a_Left.m_Data != a_Right.m_Data && std::string_view(a_Left) < std::string_view(a_Right);
+  }
+
+  // nlohmann::basic_json puts keys into its error messages like this
+  friend std::string operator+(const char* a_Left, const JsonKey& a_Right) {
+    return a_Left + a_Right.str();
+  }
+
+private:
+  void Copy(std::string_view a_String);
+  void Release();
+
+  // Where the characters are, only the ones on the heap have to be freed by the key itself
+  enum class Storage : uint8_t {
+    Shared,
+    Arena,
+    Heap
+  };
+
+  const char* m_Data = "";
+  uint32_t m_Size = 0;
+  Storage m_Storage = Storage::Shared;
+};
@@ -0,0 +1,509 @@
+#include "json_output.h"
+#include "generator.h"
+#include "json_writer.h"
+
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+// Every script bind in the index gets an entry even if its file couldn't be extracted, those are left
+// null and written as an empty template. When two files end up with the same name the last one wins
+std::map<std::string, const json*> CollectScriptBinds(const ExtractionCache& a_Cache) {
+  std::map<std::string, const json*> scriptbinds{};
+  for (auto& compound : a_Cache.index) {
+    scriptbinds.emplace(compound.name, nullptr);
+  }
+  for (auto& compound : a_Cache.index) {
+    auto cached = a_Cache.compounds.find(compound.fileName);
+    if (cached != a_Cache.compounds.end() && cached->second.result.extracted) {
+      scriptbinds[cached->second.result.name] = &cached->second.result.scriptbind;
+    }
+  }
+  return scriptbinds;
+}
+
+// A script bind that couldn't be extracted is written as an empty template
+template <typename Writer>
+void WriteScriptBind(const json* a_ScriptBind, Writer& a_Writer) {
+  if (a_ScriptBind) {
+    WriteJson(*a_ScriptBind, a_Writer);
+    return;
+  }
+
+  a_Writer.StartObject();
+  a_Writer.Key("description");
+  a_Writer.String("");
+  a_Writer.Key("methods");
+  a_Writer.StartObject();
+  a_Writer.EndObject();
+  a_Writer.EndObject();
+}
+
+template <typename Writer>
+void WriteScriptBinds(const ExtractionCache& a_Cache, Writer& a_Writer) {
+  auto scriptbinds = CollectScriptBinds(a_Cache);
+  if (scriptbinds.empty()) {
+    a_Writer.Null();
+    return;
+  }
+
+  a_Writer.StartObject();
+  a_Writer.Key("scriptbinds");
+  a_Writer.StartObject();
+
+  for (auto& scriptbind : scriptbinds) {
+    a_Writer.Key(scriptbind.first.c_str(), static_cast<rapidjson::SizeType>(scriptbind.first.size()));
+    WriteScriptBind(scriptbind.second, a_Writer);
+  }
+
+  a_Writer.EndObject();
+  a_Writer.EndObject();
+}
+
+bool WriteScriptBinds(const std::string& a_FilePath, const ExtractionCache& a_Cache, bool a_Compact) {
+  return WriteJsonFile(a_FilePath, [&](rapidjson::FileWriteStream& a_Stream) {
+    if (a_Compact) {
+      rapidjson::Writer<rapidjson::FileWriteStream> writer{a_Stream};
+      WriteScriptBinds(a_Cache, writer);
+    }
+    else {
+      rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer{a_Stream};
+      writer.SetIndent(' ', 2);
+      WriteScriptBinds(a_Cache, writer);
+    }
+  });
+}
+
+// A member of a json object, or null when it isn't there. Unlike json::value this doesn't copy anything
+const json& Member(const json& a_Object, const JsonKey& a_Key) {
+  static const json null{};
+  auto member = a_Object.find(a_Key);
+  return member != a_Object.end() ? *member : null;
+}
+
+// File systems that ignore case see two names as the same file when this makes them the same
+std::string LowerCase(std::string a_String) {
+  std::transform(a_String.begin(), a_String.end(), a_String.begin(), [](char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+  });
+  return a_String;
+}
+
+bool IsShardFileChar(char a_Char) {
+  return (a_Char >= 'a' && a_Char <= 'z') || (a_Char >= 'A' && a_Char <= 'Z') || (a_Char >= '0' && a_Char <= '9') ||
+         a_Char == '_' || a_Char == '-';
+}
+
+// A script bind's shard is named after it, anything that doesn't belong in a file name is replaced. That can
+// make two names the same, and so can a file system that ignores case, so a name that is taken already gets a
+// number after it. The script binds come in sorted, which means the same one gets the number every time
+std::vector<std::string> ShardFileNames(const std::map<std::string, const json*>& a_ScriptBinds) {
+  std::vector<std::string> fileNames{};
+  fileNames.reserve(a_ScriptBinds.size());
+  std::unordered_set<std::string> taken{};
+  for (auto& scriptbind : a_ScriptBinds) {
+    auto name = std::string{};
+    for (auto c : scriptbind.first) {
+      name += IsShardFileChar(c) ? c : '_';
+    }
+
+    auto unique = name;
+    for (auto number = 2; !taken.insert(LowerCase(unique)).second; number++) {
+      unique = name + "_" + std::to_string(number);
+    }
+    fileNames.push_back("scriptbinds/" + unique + ".json");
+  }
+  return fileNames;
+}
+
+// Only files that look like the ones ShardFileNames comes up with are ever removed, whatever the manifest says
+bool IsShardFileName(const std::string& a_FileName) {
+  const auto prefix = std::string_view{"scriptbinds/"};
+  const auto extension = std::string_view{".json"};
+  if (a_FileName.size() <= prefix.size() + extension.size() || a_FileName.compare(0, prefix.size(), prefix) != 0 ||
+      a_FileName.compare(a_FileName.size() - extension.size(), extension.size(), extension) != 0) {
+    return false;
+  }
+  return std::all_of(a_FileName.begin() + prefix.size(), a_FileName.end() - extension.size(), IsShardFileChar);
+}
+
+// What the last manifest said about a script bind's shard
+struct ShardRecord {
+  std::string hash;
+  std::string file;
+};
+
+// The shards that the last manifest listed, keyed by script bind name. A manifest that can't be read is treated
+// as if there wasn't one, every shard is written again
+std::unordered_map<std::string, ShardRecord> LoadShardRecords(const std::string& a_ManifestPath) {
+  std::unordered_map<std::string, ShardRecord> records{};
+  std::ifstream file{a_ManifestPath};
+  if (!file.is_open()) {
+    return records;
+  }
+
+  // The manifest is only needed until the records are picked out of it
+  JsonArena arena{};
+  JsonArenaScope arenaScope{&arena};
+  json manifest{};
+  try {
+    file >> manifest;
+  }
+  catch (const std::exception&) {
+    return records;
+  }
+
+  if (!manifest.is_object() || manifest.value("version", 0) != g_ShardManifestVersion) {
+    return records;
+  }
+
+  auto& scriptbinds = Member(manifest, "scriptbinds");
+  if (scriptbinds.is_object()) {
+    for (auto it = scriptbinds.begin(); it != scriptbinds.end(); ++it) {
+      auto& hash = Member(it.value(), "hash");
+      auto& fileName = Member(it.value(), "file");
+      if (hash.is_string() && fileName.is_string()) {
+        records.emplace(it.key(), ShardRecord{hash.get<std::string>(), fileName.get<std::string>()});
+      }
+    }
+  }
+  return records;
+}
+
+bool WriteShard(const std::string& a_FilePath, const rapidjson::StringBuffer& a_Contents) {
+  auto file = fopen(a_FilePath.c_str(), "w");
+  if (!file) {
+    return false;
+  }
+
+  auto written = fwrite(a_Contents.GetString(), 1, a_Contents.GetSize(), file) == a_Contents.GetSize();
+  return fclose(file) == 0 && written;
+}
+
+bool WriteScriptBindShards(const std::string& a_OutputDir, const ExtractionCache& a_Cache, bool a_Compact,
+                           size_t& a_ShardsWritten) {
+  a_ShardsWritten = 0;
+  auto manifestPath = JoinPath(a_OutputDir, "scriptbinds.manifest.json");
+  auto oldRecords = LoadShardRecords(manifestPath);
+  auto scriptbinds = CollectScriptBinds(a_Cache);
+  auto fileNames = ShardFileNames(scriptbinds);
+
+  auto error = std::error_code{};
+  std::filesystem::create_directories(JoinPath(a_OutputDir, "scriptbinds"), error);
+
+  // Every shard is put together in memory first, it's only written when its hash doesn't match the one in the
+  // last manifest or when the file has gone missing or moved since then. A shard that couldn't be written gets an
+  // empty hash in the manifest, so the next run doesn't trust whatever is left of the file and tries again
+  auto written = true;
+  std::vector<std::string> hashes{};
+  hashes.reserve(scriptbinds.size());
+  rapidjson::StringBuffer contents{};
+  auto fileName = fileNames.begin();
+  for (auto& scriptbind : scriptbinds) {
+    contents.Clear();
+    if (a_Compact) {
+      rapidjson::Writer<rapidjson::StringBuffer> writer{contents};
+      WriteScriptBind(scriptbind.second, writer);
+    }
+    else {
+      rapidjson::PrettyWriter<rapidjson::StringBuffer> writer{contents};
+      writer.SetIndent(' ', 2);
+      WriteScriptBind(scriptbind.second, writer);
+    }
+
+    hashes.push_back(HashToString(HashContents(contents.GetString(), contents.GetSize())));
+    auto& shardFile = *fileName++;
+    auto filePath = JoinPath(a_OutputDir, shardFile);
+    auto old = oldRecords.find(scriptbind.first);
+    if (old != oldRecords.end() && old->second.hash == hashes.back() && old->second.file == shardFile &&
+        std::filesystem::exists(filePath, error)) {
+      continue;
+    }
+
+    if (WriteShard(filePath, contents)) {
+      a_ShardsWritten++;
+    }
+    else {
+      hashes.back().clear();
+      written = false;
+    }
+  }
+
+  // Files that the last manifest listed and that no script bind uses anymore belong to script binds that are gone
+  // or have been renamed, only the files this wrote are removed
+  std::unordered_set<std::string> used{};
+  for (auto& name : fileNames) {
+    used.insert(LowerCase(name));
+  }
+  for (auto& old : oldRecords) {
+    if (IsShardFileName(old.second.file) && used.count(LowerCase(old.second.file)) == 0) {
+      std::filesystem::remove(JoinPath(a_OutputDir, old.second.file), error);
+    }
+  }
+
+  // The manifest is what the editor loads first, so it has the descriptions and doesn't need any of the shards
+  return WriteJsonFile(manifestPath, [&](rapidjson::FileWriteStream& a_Stream) {
+    auto writeManifest = [&](auto& a_Writer) {
+      a_Writer.StartObject();
+      a_Writer.Key("version");
+      a_Writer.Int(g_ShardManifestVersion);
+      a_Writer.Key("scriptbinds");
+      a_Writer.StartObject();
+      auto hash = hashes.begin();
+      auto fileName = fileNames.begin();
+      for (auto& scriptbind : scriptbinds) {
+        auto description = scriptbind.second ? &Member(*scriptbind.second, g_DescriptionKey) : nullptr;
+        a_Writer.Key(scriptbind.first.c_str(), static_cast<rapidjson::SizeType>(scriptbind.first.size()));
+        a_Writer.StartObject();
+        a_Writer.Key("description");
+        a_Writer.String(description && description->is_string() ? description->get_ref<const std::string&>().c_str() : "");
+        a_Writer.Key("file");
+        a_Writer.String(fileName->c_str(), static_cast<rapidjson::SizeType>(fileName->size()));
+        a_Writer.Key("hash");
+        a_Writer.String(hash->c_str(), static_cast<rapidjson::SizeType>(hash->size()));
+        a_Writer.EndObject();
+        ++hash;
+        ++fileName;
+      }
+      a_Writer.EndObject();
+      a_Writer.EndObject();
+    };
+
+    if (a_Compact) {
+      rapidjson::Writer<rapidjson::FileWriteStream> writer{a_Stream};
+      writeManifest(writer);
+    }
+    else {
+      rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer{a_Stream};
+      writer.SetIndent(' ', 2);
+      writeManifest(writer);
+    }
+  }) && written;
+}
+
+// Where a description ended up in the string table, in UTF-16 code units since that's what javascript slices by
+struct StringRef {
+  size_t offset = 0;
+  size_t length = 0;
+};
+
+// All of the descriptions in the index are put into one string, a description that shows up more than once
+// (like the ones that doxygen fills in for return values) is only stored the first time
+class StringTable {
+public:
+  StringRef Add(const json& a_Value) {
+    if (!a_Value.is_string() || a_Value.get_ref<const std::string&>().empty()) {
+      return {};
+    }
+
+    auto& text = a_Value.get_ref<const std::string&>();
+    auto added = m_Refs.emplace(text, StringRef{m_Length, Utf16Length(text)});
+    if (added.second) {
+      m_Text += text;
+      m_Length += added.first->second.length;
+    }
+    return added.first->second;
+  }
+
+  const std::string& Text() const { return m_Text; }
+
+private:
+  // Every byte that doesn't continue a utf-8 sequence starts a code unit, four byte sequences take up two of them
+  static size_t Utf16Length(std::string_view a_Text) {
+    auto length = size_t{0};
+    for (auto c : a_Text) {
+      auto byte = static_cast<unsigned char>(c);
+      length += (byte & 0xC0) != 0x80 ? 1 : 0;
+      length += byte >= 0xF0 ? 1 : 0;
+    }
+    return length;
+  }
+
+  // The keys point into the json of the cache, which doesn't change while the index is written
+  std::unordered_map<std::string_view, StringRef> m_Refs;
+  std::string m_Text;
+  size_t m_Length = 0;
+};
+
+// A method in the sorted method table, methods are sorted on their lower case name first since that's how the
+// editor matches them, the exact name and the script bind only keep the order the same from run to run
+struct IndexedMethod {
+  std::string lowerName;
+  std::string_view name;
+  unsigned scriptbind;
+  const json* method;
+
+  bool operator<(const IndexedMethod& a_Other) const {
+    return std::tie(lowerName, name, scriptbind) < std::tie(a_Other.lowerName, a_Other.name, a_Other.scriptbind);
+  }
+};
+
+template <typename Writer>
+void WriteStringRef(StringRef a_Ref, Writer& a_Writer) {
+  a_Writer.Uint64(a_Ref.offset);
+  a_Writer.Uint64(a_Ref.length);
+}
+
+template <typename Writer>
+void WriteLuaType(const json& a_Type, Writer& a_Writer) {
+  if (a_Type.is_string()) {
+    a_Writer.String(a_Type.get_ref<const std::string&>().c_str());
+  }
+  else {
+    a_Writer.Null();
+  }
+}
+
+template <typename Writer>
+void WriteIndexedMethod(const IndexedMethod& a_Method, StringTable& a_Strings, Writer& a_Writer) {
+  a_Writer.StartArray();
+  a_Writer.String(a_Method.name.data(), static_cast<rapidjson::SizeType>(a_Method.name.size()));
+  a_Writer.Uint(a_Method.scriptbind);
+  WriteStringRef(a_Strings.Add(Member(*a_Method.method, g_DescriptionKey)), a_Writer);
+
+  // Every parameter is a single object with the parameter's name as its key
+  a_Writer.StartArray();
+  auto params = a_Method.method->find(g_ParamsKey);
+  if (params != a_Method.method->end() && params->is_array()) {
+    for (auto& param : *params) {
+      if (!param.is_object()) {
+        continue;
+      }
+      for (auto& member : param.get_ref<const json::object_t&>()) {
+        a_Writer.StartArray();
+        a_Writer.String(member.first.c_str(), static_cast<rapidjson::SizeType>(member.first.size()));
+        WriteLuaType(Member(member.second, g_TypeKey), a_Writer);
+        WriteStringRef(a_Strings.Add(Member(member.second, g_DescriptionKey)), a_Writer);
+        a_Writer.EndArray();
+      }
+    }
+  }
+  a_Writer.EndArray();
+
+  a_Writer.StartArray();
+  auto rets = a_Method.method->find(g_RetKey);
+  if (rets != a_Method.method->end() && rets->is_array()) {
+    for (auto& ret : *rets) {
+      a_Writer.StartArray();
+      WriteLuaType(Member(ret, g_TypeKey), a_Writer);
+      WriteStringRef(a_Strings.Add(Member(ret, g_DescKey)), a_Writer);
+      a_Writer.EndArray();
+    }
+  }
+  a_Writer.EndArray();
+  a_Writer.EndArray();
+}
+
+template <typename Writer>
+void WriteScriptBindIndex(const ExtractionCache& a_Cache, Writer& a_Writer) {
+  auto scriptbinds = CollectScriptBinds(a_Cache);
+  StringTable strings{};
+
+  std::vector<IndexedMethod> methods{};
+  std::vector<StringRef> scriptbindDescriptions{};
+  std::vector<std::vector<size_t>> scriptbindMethods(scriptbinds.size());
+  for (auto& scriptbind : scriptbinds) {
+    auto index = static_cast<unsigned>(scriptbindDescriptions.size());
+    if (!scriptbind.second) {
+      scriptbindDescriptions.push_back({});
+      continue;
+    }
+
+    scriptbindDescriptions.push_back(strings.Add(Member(*scriptbind.second, g_DescriptionKey)));
+    auto scriptbindMethodsJson = scriptbind.second->find(g_MethodsKey);
+    if (scriptbindMethodsJson == scriptbind.second->end() || !scriptbindMethodsJson->is_object()) {
+      continue;
+    }
+
+    // The object itself is walked since its keys have to stay where they are while the methods are sorted
+    for (auto& method : scriptbindMethodsJson->get_ref<const json::object_t&>()) {
+      auto name = std::string_view(method.first);
+      auto lowerName = std::string(name);
+      std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), [](char a_Char) {
+        return a_Char >= 'A' && a_Char <= 'Z' ? static_cast<char>(a_Char - 'A' + 'a') : a_Char;
+      });
+      methods.push_back({ std::move(lowerName), name, index, &method.second });
+    }
+  }
+  std::sort(methods.begin(), methods.end());
+  for (auto i = size_t{0}; i < methods.size(); i++) {
+    scriptbindMethods[methods[i].scriptbind].push_back(i);
+  }
+
+  // The methods are written first so that every description is in the string table by the time it's written
+  auto methodsBuffer = rapidjson::StringBuffer{};
+  rapidjson::Writer<rapidjson::StringBuffer> methodsWriter{methodsBuffer};
+  methodsWriter.StartArray();
+  for (auto& method : methods) {
+    WriteIndexedMethod(method, strings, methodsWriter);
+  }
+  methodsWriter.EndArray();
+
+  a_Writer.StartObject();
+  a_Writer.Key("version");
+  a_Writer.Int(g_ScriptBindIndexVersion);
+  a_Writer.Key("strings");
+  a_Writer.String(strings.Text().c_str(), static_cast<rapidjson::SizeType>(strings.Text().size()));
+
+  a_Writer.Key("scriptbinds");
+  a_Writer.StartArray();
+  auto scriptbindIndex = size_t{0};
+  for (auto& scriptbind : scriptbinds) {
+    a_Writer.StartArray();
+    a_Writer.String(scriptbind.first.c_str(), static_cast<rapidjson::SizeType>(scriptbind.first.size()));
+    WriteStringRef(scriptbindDescriptions[scriptbindIndex], a_Writer);
+    a_Writer.StartArray();
+    for (auto method : scriptbindMethods[scriptbindIndex]) {
+      a_Writer.Uint64(method);
+    }
+    a_Writer.EndArray();
+    a_Writer.EndArray();
+    scriptbindIndex++;
+  }
+  a_Writer.EndArray();
+
+  a_Writer.Key("methods");
+  a_Writer.RawValue(methodsBuffer.GetString(), methodsBuffer.GetSize(), rapidjson::kArrayType);
+
+  // Every one and two letter prefix points at the range of methods that start with it, a longer prefix only
+  // has to look through the range of its first two letters
+  a_Writer.Key("prefixes");
+  a_Writer.StartObject();
+  for (auto length = size_t{1}; length <= 2; length++) {
+    for (auto first = size_t{0}; first < methods.size();) {
+      auto prefix = std::string_view(methods[first].lowerName).substr(0, length);
+      auto last = first + 1;
+      while (last < methods.size() && std::string_view(methods[last].lowerName).substr(0, length) == prefix) {
+        last++;
+      }
+
+      if (prefix.size() == length) {
+        a_Writer.Key(prefix.data(), static_cast<rapidjson::SizeType>(prefix.size()));
+        a_Writer.StartArray();
+        a_Writer.Uint64(first);
+        a_Writer.Uint64(last);
+        a_Writer.EndArray();
+      }
+      first = last;
+    }
+  }
+  a_Writer.EndObject();
+  a_Writer.EndObject();
+}
+
+bool WriteScriptBindIndex(const std::string& a_FilePath, const ExtractionCache& a_Cache) {
+  return WriteJsonFile(a_FilePath, [&](rapidjson::FileWriteStream& a_Stream) {
+    rapidjson::Writer<rapidjson::FileWriteStream> writer{a_Stream};
+    WriteScriptBindIndex(a_Cache, writer);
+  });
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "cache.h"
+
+#include <string>
+
+// Streams every script bind in a_Cache into scriptbinds.json, sorted by name the same way a json object
+// would be. Nothing is put together in memory first, each script bind is written as soon as it is reached
+bool WriteScriptBinds(const std::string& a_FilePath, const ExtractionCache& a_Cache, bool a_Compact);
+
+// Bump this whenever the layout of scriptbinds.index.json changes so that the editor doesn't misread it
+const int g_ScriptBindIndexVersion = 1;
+
+// Writes the same script binds as WriteScriptBinds, but laid out so that the editor can complete methods right
+// after loading the file instead of walking all of it first:
+//   "strings"      every description in a single string, they are referred to by an offset and a length in
+//                  UTF-16 code units
+//   "scriptbinds"  [name, description offset, description length, [method indexes]] sorted by name
+//   "methods"      [name, script bind index, description offset, description length, params, rets] sorted by
+//                  their lower case name, params are [name, type, description offset, description length] and
+//                  rets are [type, description offset, description length]
+//   "prefixes"     the first one and two lower case letters of the method names, each with the range of methods
+//                  [first, last) that start with them
+bool WriteScriptBindIndex(const std::string& a_FilePath, const ExtractionCache& a_Cache);
+
+// Bump this whenever the layout of scriptbinds.manifest.json changes
+const int g_ShardManifestVersion = 1;
+
+// Writes every script bind into its own file in a_OutputDir/scriptbinds, laid out the same way as it is in
+// scriptbinds.json, along with scriptbinds.manifest.json which lists the name, description, file and hash
+// of every script bind. Shards whose hash is the same as in the last manifest aren't written again and the
+// shards of script binds that are gone are removed. Names that would end up as the same file get a number after
+// them. a_ShardsWritten says how many files were actually written
+bool WriteScriptBindShards(const std::string& a_OutputDir, const ExtractionCache& a_Cache, bool a_Compact,
+                           size_t& a_ShardsWritten);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "extractor.h"
+
+#include "rapidjson/filewritestream.h"
+
+#include <cstdio>
+#include <string>
+
+// Walks a json value and hands it to a rapidjson writer piece by piece
+template <typename Writer>
+void WriteJson(const json& a_Value, Writer& a_Writer) {
+  switch (a_Value.type()) {
+    case json::value_t::object:
+      // The members are walked through the object itself, its iterators hand out a copy of every key
+      a_Writer.StartObject();
+      for (auto& member : a_Value.get_ref<const json::object_t&>()) {
+        a_Writer.Key(member.first.c_str(), static_cast<rapidjson::SizeType>(member.first.size()));
+        WriteJson(member.second, a_Writer);
+      }
+      a_Writer.EndObject();
+      break;
+    case json::value_t::array:
+      a_Writer.StartArray();
+      for (auto& value : a_Value) {
+        WriteJson(value, a_Writer);
+      }
+      a_Writer.EndArray();
+      break;
+    case json::value_t::string: {
+      auto& text = a_Value.get_ref<const std::string&>();
+      a_Writer.String(text.c_str(), static_cast<rapidjson::SizeType>(text.size()));
+      break;
+    }
+    case json::value_t::boolean:
+      a_Writer.Bool(a_Value.get<bool>());
+      break;
+    case json::value_t::number_integer:
+      a_Writer.Int64(a_Value.get<int64_t>());
+      break;
+    case json::value_t::number_unsigned:
+      a_Writer.Uint64(a_Value.get<uint64_t>());
+      break;
+    case json::value_t::number_float:
+      a_Writer.Double(a_Value.get<double>());
+      break;
+    default:
+      a_Writer.Null();
+      break;
+  }
+}
+
+// Opens a_FilePath and hands a buffered stream for it to a_Write, returns false if anything couldn't be written
+template <typename Write>
+bool WriteJsonFile(const std::string& a_FilePath, Write&& a_Write) {
+  auto file = fopen(a_FilePath.c_str(), "w");
+  if (!file) {
+    return false;
+  }
+
+  char buffer[64 * 1024];
+  rapidjson::FileWriteStream stream{file, buffer, sizeof(buffer)};
+  a_Write(stream);
+
+  stream.Flush();
+  auto written = !ferror(file);
+  return fclose(file) == 0 && written;
+}
@@ -0,0 +1,236 @@
+#include "lua_types.h"
+#include "cache.h"
+#include "text.h"
+
+#include "rapidjson/document.h"
+#include "rapidjson/error/en.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+struct LuaTypeEntry {
+  std::string_view cppType;
+  LuaType luaType;
+};
+
+// Translates C++ values to Lua values. The types are canonical (see CanonicalizeCppType) so every way of
+// spelling them ends up here. This has to stay sorted since it's searched with a binary search, which the
+// static_assert below keeps an eye on
+constexpr LuaTypeEntry g_BuiltinLuaTypes[] = {
+  { "Entity", LuaType::Number },
+  { "KeyCode", LuaType::Number },
+  { "ScriptHandle", LuaType::Pointer },
+  { "ScriptTable", LuaType::Table },
+  { "SmartScriptTable", LuaType::Table },
+  { "TileCoord", LuaType::Table },
+  { "bool", LuaType::Boolean },
+  { "char*", LuaType::String },
+  { "double", LuaType::Number },
+  { "float", LuaType::Number },
+  { "glm::vec2", LuaType::Table },
+  { "glm::vec3", LuaType::Table },
+  { "int", LuaType::Number },
+  { "uint32_t", LuaType::Number },
+  { "unsigned int", LuaType::Number }
+};
+
+// The namespaces of the engine and the game, they are taken off of types since the script binds can spell a
+// type with its full namespace or with the part of it that's left from inside of hexe. Only one of these is
+// taken off and only when it's the whole prefix, so the longer ones have to come first
+constexpr std::string_view g_EngineNamespaces[] = {
+  "hexe::service::scripts::", "service::scripts::", "scripts::",
+  "hexe::gameplay::tile::", "gameplay::tile::", "tile::",
+  "hexe::component::", "component::",
+  "hexe::input::", "input::",
+  "hexegame::", "hexe::"
+};
+
+constexpr bool IsSorted(const LuaTypeEntry* a_Entries, size_t a_Count) {
+  for (auto i = size_t{1}; i < a_Count; i++) {
+    if (!(a_Entries[i - 1].cppType < a_Entries[i].cppType)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(IsSorted(g_BuiltinLuaTypes, sizeof(g_BuiltinLuaTypes) / sizeof(g_BuiltinLuaTypes[0])),
+              "g_BuiltinLuaTypes has to be sorted");
+
+constexpr size_t CppTypeLength(bool a_Longest) {
+  auto length = g_BuiltinLuaTypes[0].cppType.size();
+  for (auto& entry : g_BuiltinLuaTypes) {
+    length = a_Longest ? std::max(length, entry.cppType.size()) : std::min(length, entry.cppType.size());
+  }
+  return length;
+}
+
+// Types that are shorter or longer than every built in one are unknown without having to search for them
+constexpr size_t g_ShortestCppType = CppTypeLength(false);
+constexpr size_t g_LongestCppType = CppTypeLength(true);
+
+const char* g_LuaTypeNames[] = { "any", "string", "boolean", "number", "pointer", "table" };
+
+// Types from LoadLuaTypes, sorted the same way as the built in ones
+std::vector<std::pair<std::string, LuaType>> g_ExtraLuaTypes{};
+uint64_t g_ExtraLuaTypesHash = 0;
+
+const char* GetLuaTypeName(LuaType a_Type) {
+  return g_LuaTypeNames[static_cast<size_t>(a_Type)];
+}
+
+// Takes the engine's namespace off of the front of a name, other namespaces like glm and std are kept
+std::string_view StripEngineNamespaces(std::string_view a_Name) {
+  if (a_Name.substr(0, 2) == "::") {
+    a_Name.remove_prefix(2);
+  }
+
+  for (auto ns : g_EngineNamespaces) {
+    if (a_Name.substr(0, ns.size()) == ns) {
+      a_Name.remove_prefix(ns.size());
+      break;
+    }
+  }
+  return a_Name;
+}
+
+void CanonicalizeCppType(std::string_view a_CppType, std::string& a_Canonical) {
+  a_Canonical.clear();
+  auto pointers = size_t{0};
+  auto pos = size_t{0};
+
+  while (pos < a_CppType.size()) {
+    auto c = a_CppType[pos];
+    if (IsWhitespace(c) || c == '&' || c == '*') {
+      pointers += c == '*' ? 1 : 0;
+      pos++;
+      continue;
+    }
+
+    // A word runs until the next bit of whitespace, reference or pointer, unless it's inside of template arguments
+    auto start = pos;
+    auto depth = 0;
+    for (; pos < a_CppType.size(); pos++) {
+      c = a_CppType[pos];
+      if (depth == 0 && (IsWhitespace(c) || c == '&' || c == '*')) {
+        break;
+      }
+      depth += c == '<' ? 1 : c == '>' ? -1 : 0;
+    }
+
+    auto word = a_CppType.substr(start, pos - start);
+    if (word == "const" || word == "volatile") {
+      continue;
+    }
+
+    if (!a_Canonical.empty()) {
+      a_Canonical += ' ';
+    }
+    a_Canonical.append(StripEngineNamespaces(word));
+  }
+
+  a_Canonical.append(pointers, '*');
+}
+
+LuaType FindLuaType(std::string_view a_CanonicalType) {
+  if (!g_ExtraLuaTypes.empty()) {
+    auto extra = std::lower_bound(g_ExtraLuaTypes.begin(), g_ExtraLuaTypes.end(), a_CanonicalType,
+                                  [](const std::pair<std::string, LuaType>& a_Entry, std::string_view a_Type) {
+      return std::string_view(a_Entry.first) < a_Type;
+    });
+    if (extra != g_ExtraLuaTypes.end() && extra->first == a_CanonicalType) {
+      return extra->second;
+    }
+  }
+
+  if (a_CanonicalType.size() < g_ShortestCppType || a_CanonicalType.size() > g_LongestCppType) {
+    return LuaType::Unknown;
+  }
+
+  auto builtin = std::lower_bound(std::begin(g_BuiltinLuaTypes), std::end(g_BuiltinLuaTypes), a_CanonicalType,
+                                  [](const LuaTypeEntry& a_Entry, std::string_view a_Type) {
+    return a_Entry.cppType < a_Type;
+  });
+  return builtin != std::end(g_BuiltinLuaTypes) && builtin->cppType == a_CanonicalType ? builtin->luaType : LuaType::Unknown;
+}
+
+LuaType LuaTypeResolver::Resolve(const std::string& a_CppType) {
+  auto resolved = m_Resolved.find(a_CppType);
+  if (resolved != m_Resolved.end()) {
+    return resolved->second;
+  }
+
+  CanonicalizeCppType(a_CppType, m_Canonical);
+  auto luaType = FindLuaType(m_Canonical);
+  m_Resolved.emplace(a_CppType, luaType);
+  return luaType;
+}
+
+bool LoadLuaTypes(const std::string& a_FilePath, std::vector<std::string>& a_Warnings) {
+  std::ifstream file{a_FilePath};
+  if (!file.is_open()) {
+    return false;
+  }
+
+  std::stringstream contents{};
+  contents << file.rdbuf();
+  auto text = contents.str();
+
+  // rapidjson keeps the members in the order they're written in, so an entry can win over the ones in front of it
+  rapidjson::Document types{};
+  types.Parse(text.data(), text.size());
+  if (types.HasParseError()) {
+    a_Warnings.push_back("Couldn't parse " + a_FilePath + ". " + rapidjson::GetParseError_En(types.GetParseError()) +
+                         " at offset " + std::to_string(types.GetErrorOffset()));
+    return false;
+  }
+
+  if (!types.IsObject()) {
+    a_Warnings.push_back("The types in " + a_FilePath + " have to be in a json object");
+    return false;
+  }
+
+  for (auto member = types.MemberBegin(); member != types.MemberEnd(); ++member) {
+    const auto cppType = std::string{member->name.GetString(), member->name.GetStringLength()};
+    auto luaType = LuaType::Unknown;
+    if (member->value.IsString()) {
+      auto name = std::string_view{member->value.GetString(), member->value.GetStringLength()};
+      for (auto i = size_t{1}; i < sizeof(g_LuaTypeNames) / sizeof(g_LuaTypeNames[0]); i++) {
+        if (name == g_LuaTypeNames[i]) {
+          luaType = static_cast<LuaType>(i);
+        }
+      }
+    }
+
+    if (luaType == LuaType::Unknown) {
+      a_Warnings.push_back("Unknown Lua type for " + cppType + " in " + a_FilePath);
+      continue;
+    }
+
+    // Different spellings can end up as the same type, the entry that comes later (or is in a file that's loaded
+    // later) wins. The types are kept sorted as they're added, more than one file can be loaded
+    auto canonical = std::string{};
+    CanonicalizeCppType(cppType, canonical);
+    auto extra = std::lower_bound(g_ExtraLuaTypes.begin(), g_ExtraLuaTypes.end(), canonical,
+                                  [](const std::pair<std::string, LuaType>& a_Entry, const std::string& a_Type) {
+      return a_Entry.first < a_Type;
+    });
+    if (extra != g_ExtraLuaTypes.end() && extra->first == canonical) {
+      a_Warnings.push_back("The Lua type for " + cppType + " in " + a_FilePath + " replaces the one given for " +
+                           canonical + " before it");
+      extra->second = luaType;
+    }
+    else {
+      g_ExtraLuaTypes.emplace(extra, std::move(canonical), luaType);
+    }
+  }
+
+  g_ExtraLuaTypesHash = g_ExtraLuaTypesHash * 31 + HashContents(text.data(), text.size());
+  return true;
+}
+
+uint64_t LuaTypesHash() {
+  return g_ExtraLuaTypesHash;
+}
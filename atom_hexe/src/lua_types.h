@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// The Lua types that the C++ types of the script binds are translated to
+enum class LuaType : uint8_t {
+  Unknown,
+  String,
+  Boolean,
+  Number,
+  Pointer,
+  Table
+};
+
+// The name of a Lua type the way it's written in scriptbinds.json, unknown types are written as any
+const char* GetLuaTypeName(LuaType a_Type);
+
+// Brings a C++ type down to the way the type table spells it. Const, volatile and references are dropped,
+// the namespaces of the engine are taken off and whitespace is tidied up, so "const hexe::input::KeyCode &"
+// becomes "KeyCode". Pointers are kept since a char pointer is a string but a char isn't
+void CanonicalizeCppType(std::string_view a_CppType, std::string& a_Canonical);
+
+// Translates a canonical C++ type into a Lua type without allocating anything
+LuaType FindLuaType(std::string_view a_CanonicalType);
+
+// Translates the C++ types that doxygen writes into Lua types. Every distinct spelling is only canonicalized
+// and looked up the first time it's seen, after that it comes straight out of the resolver's own cache.
+// A resolver isn't shared between threads, every thread that extracts script binds gets its own
+class LuaTypeResolver {
+public:
+  LuaType Resolve(const std::string& a_CppType);
+
+private:
+  std::unordered_map<std::string, LuaType> m_Resolved;
+  std::string m_Canonical;
+};
+
+// Adds the types in a json file like {"hexe::audio::SoundId": "number"} on top of the built in ones, a type
+// in the file wins over a built in one and is canonicalized like any other type. When two entries come out as
+// the same canonical type the later one wins, files that are loaded later count as later. Returns false if the
+// file can't be read, entries that can't be used or that replace another one are reported in a_Warnings. This
+// has to happen before any script binds are extracted
+bool LoadLuaTypes(const std::string& a_FilePath, std::vector<std::string>& a_Warnings);
+
+// Hash of the types that were loaded with LoadLuaTypes, 0 if there aren't any. Script binds that were
+// extracted with different types can't be taken out of the cache
+uint64_t LuaTypesHash();
@@ -0,0 +1,135 @@
+#include "mapped_file.h"
+
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+void MappedFile::Close() {
+  if (m_MappedSize > 0) {
+#ifdef _WIN32
+    UnmapViewOfFile(m_Data);
+#else
+    munmap(m_Data, m_MappedSize);
+#endif
+  }
+
+  m_Data = nullptr;
+  m_Size = 0;
+  m_MappedSize = 0;
+  m_Buffer.clear();
+}
+
+bool MappedFile::ReadIntoBuffer(const std::string& a_FilePath) {
+  auto file = fopen(a_FilePath.c_str(), "rb");
+  if (!file) {
+    return false;
+  }
+
+  m_Buffer.assign(m_Size + 1, '\0');
+  m_Size = fread(m_Buffer.data(), 1, m_Size, file);
+  m_Buffer[m_Size] = '\0';
+  m_Data = m_Buffer.data();
+  fclose(file);
+  return true;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& a_FilePath, bool a_Map) {
+  Close();
+
+  auto file = CreateFileA(a_FilePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                          nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER fileSize{};
+  GetFileSizeEx(file, &fileSize);
+  m_Size = static_cast<size_t>(fileSize.QuadPart);
+
+  SYSTEM_INFO systemInfo{};
+  GetSystemInfo(&systemInfo);
+
+  // The end of the last page is filled with zeros, unless the file happens to fill it up completely
+  if (!a_Map || m_Size == 0 || m_Size % systemInfo.dwPageSize == 0) {
+    CloseHandle(file);
+    return ReadIntoBuffer(a_FilePath);
+  }
+
+  auto mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  auto view = mapping ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : nullptr;
+
+  // The view keeps the file mapped on its own, the handles aren't needed anymore
+  if (mapping) {
+    CloseHandle(mapping);
+  }
+  CloseHandle(file);
+
+  if (!view) {
+    return ReadIntoBuffer(a_FilePath);
+  }
+
+  m_Data = static_cast<char*>(view);
+  m_MappedSize = m_Size;
+  return true;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& a_FilePath, bool a_Map) {
+  Close();
+
+  auto fd = open(a_FilePath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat fileStat{};
+  if (fstat(fd, &fileStat) != 0) {
+    close(fd);
+    return false;
+  }
+
+  m_Size = static_cast<size_t>(fileStat.st_size);
+  if (!a_Map || m_Size == 0) {
+    close(fd);
+    return ReadIntoBuffer(a_FilePath);
+  }
+
+  // Reserve room for one more byte than the file has with zeroed anonymous memory first and then map the
+  // file over the start of it. Even when the file fills its last page completely the 0 is still there
+  auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  auto mappedSize = (m_Size + 1 + pageSize - 1) / pageSize * pageSize;
+
+  auto base = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    close(fd);
+    return ReadIntoBuffer(a_FilePath);
+  }
+
+  auto view = mmap(base, m_Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+  close(fd);
+
+  if (view == MAP_FAILED) {
+    munmap(base, mappedSize);
+    return ReadIntoBuffer(a_FilePath);
+  }
+
+  m_Data = static_cast<char*>(base);
+  m_MappedSize = mappedSize;
+  return true;
+}
+
+#endif
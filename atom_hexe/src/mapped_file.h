@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// A file that is mapped into memory copy on write, so parsers can write into it (tinyxml2 terminates its
+// strings in place) without the file on disk changing. There is always a 0 right after the last byte,
+// which means the contents can be parsed as a string without copying them into a bigger buffer first
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Without a_Map the file is read into a buffer instead. A file that is mapped while someone else cuts it short
+  // brings the process down (SIGBUS) as soon as the pages past its new end are touched, so a file that could be
+  // rewritten while it's being read shouldn't be mapped
+  bool Open(const std::string& a_FilePath, bool a_Map = true);
+  void Close();
+
+  char* Data() { return m_Data; }
+  size_t Size() const { return m_Size; }
+
+private:
+  // Reads the file the old fashioned way for when the mapping can't provide the 0 at the end
+  bool ReadIntoBuffer(const std::string& a_FilePath);
+
+  char* m_Data = nullptr;
+  size_t m_Size = 0;
+  size_t m_MappedSize = 0;
+  std::vector<char> m_Buffer;
+};
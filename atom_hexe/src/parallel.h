@@ -0,0 +1,41 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// The amount of threads to use when none was asked for
+inline unsigned DefaultThreadCount() {
+  auto threadCount = std::thread::hardware_concurrency();
+  return threadCount > 0 ? threadCount : 1;
+}
+
+// Runs a_Job for every index from 0 up to a_Count spread out over a_ThreadCount threads. Every thread
+// creates its own State which is handed to each job it runs, that way jobs can reuse things like xml
+// documents without any locking. Jobs are picked up in order, but can finish in any order
+template <typename State, typename Job>
+void ParallelFor(size_t a_Count, unsigned a_ThreadCount, Job&& a_Job) {
+  std::atomic<size_t> nextIndex{0};
+
+  auto worker = [&]() {
+    State state{};
+    for (auto index = nextIndex++; index < a_Count; index = nextIndex++) {
+      a_Job(state, index);
+    }
+  };
+
+  // No point in starting more threads than there are jobs, the calling thread also does work
+  auto threadCount = std::min<size_t>(std::max(a_ThreadCount, 1u), std::max<size_t>(a_Count, 1));
+  std::vector<std::thread> threads{};
+  threads.reserve(threadCount - 1);
+  for (auto i = size_t{1}; i < threadCount; i++) {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
@@ -0,0 +1,208 @@
+#include "stats.h"
+#include "json/json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Every allocation made through new is counted on the thread that made it, that way the threads don't have
+// to fight over a shared counter and the stages that run on many threads can still be measured per compound.
+// Nothing is counted until it's turned on, so a run without --stats only pays for checking the flag
+std::atomic<bool> g_CountAllocations{false};
+thread_local AllocationCounts g_ThreadAllocations{};
+
+void* AllocateCounted(size_t a_Size, size_t a_Alignment) noexcept {
+  if (g_CountAllocations.load(std::memory_order_relaxed)) {
+    g_ThreadAllocations.count++;
+    g_ThreadAllocations.bytes += a_Size;
+  }
+  a_Size = a_Size > 0 ? a_Size : 1;
+  if (a_Alignment <= alignof(std::max_align_t)) {
+    return malloc(a_Size);
+  }
+#ifdef _WIN32
+  return _aligned_malloc(a_Size, a_Alignment);
+#else
+  auto memory = static_cast<void*>(nullptr);
+  return posix_memalign(&memory, a_Alignment, a_Size) == 0 ? memory : nullptr;
+#endif
+}
+
+void FreeCounted(void* a_Memory, size_t a_Alignment) noexcept {
+#ifdef _WIN32
+  if (a_Alignment > alignof(std::max_align_t)) {
+    _aligned_free(a_Memory);
+    return;
+  }
+#else
+  (void)a_Alignment;
+#endif
+  free(a_Memory);
+}
+
+void* AllocateOrThrow(size_t a_Size, size_t a_Alignment) {
+  if (auto memory = AllocateCounted(a_Size, a_Alignment)) {
+    return memory;
+  }
+  throw std::bad_alloc{};
+}
+
+void* operator new(size_t a_Size) {
+  return AllocateOrThrow(a_Size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t a_Size) {
+  return AllocateOrThrow(a_Size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t a_Size, const std::nothrow_t&) noexcept {
+  return AllocateCounted(a_Size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t a_Size, const std::nothrow_t&) noexcept {
+  return AllocateCounted(a_Size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t a_Size, std::align_val_t a_Alignment) {
+  return AllocateOrThrow(a_Size, static_cast<size_t>(a_Alignment));
+}
+
+void* operator new[](size_t a_Size, std::align_val_t a_Alignment) {
+  return AllocateOrThrow(a_Size, static_cast<size_t>(a_Alignment));
+}
+
+void* operator new(size_t a_Size, std::align_val_t a_Alignment, const std::nothrow_t&) noexcept {
+  return AllocateCounted(a_Size, static_cast<size_t>(a_Alignment));
+}
+
+void* operator new[](size_t a_Size, std::align_val_t a_Alignment, const std::nothrow_t&) noexcept {
+  return AllocateCounted(a_Size, static_cast<size_t>(a_Alignment));
+}
+
+void operator delete(void* a_Memory) noexcept {
+  FreeCounted(a_Memory, alignof(std::max_align_t));
+}
+
+void operator delete[](void* a_Memory) noexcept {
+  FreeCounted(a_Memory, alignof(std::max_align_t));
+}
+
+void operator delete(void* a_Memory, size_t) noexcept {
+  FreeCounted(a_Memory, alignof(std::max_align_t));
+}
+
+void operator delete[](void* a_Memory, size_t) noexcept {
+  FreeCounted(a_Memory, alignof(std::max_align_t));
+}
+
+void operator delete(void* a_Memory, const std::nothrow_t&) noexcept {
+  FreeCounted(a_Memory, alignof(std::max_align_t));
+}
+
+void operator delete[](void* a_Memory, const std::nothrow_t&) noexcept {
+  FreeCounted(a_Memory, alignof(std::max_align_t));
+}
+
+void operator delete(void* a_Memory, std::align_val_t a_Alignment) noexcept {
+  FreeCounted(a_Memory, static_cast<size_t>(a_Alignment));
+}
+
+void operator delete[](void* a_Memory, std::align_val_t a_Alignment) noexcept {
+  FreeCounted(a_Memory, static_cast<size_t>(a_Alignment));
+}
+
+void operator delete(void* a_Memory, size_t, std::align_val_t a_Alignment) noexcept {
+  FreeCounted(a_Memory, static_cast<size_t>(a_Alignment));
+}
+
+void operator delete[](void* a_Memory, size_t, std::align_val_t a_Alignment) noexcept {
+  FreeCounted(a_Memory, static_cast<size_t>(a_Alignment));
+}
+
+void operator delete(void* a_Memory, std::align_val_t a_Alignment, const std::nothrow_t&) noexcept {
+  FreeCounted(a_Memory, static_cast<size_t>(a_Alignment));
+}
+
+void operator delete[](void* a_Memory, std::align_val_t a_Alignment, const std::nothrow_t&) noexcept {
+  FreeCounted(a_Memory, static_cast<size_t>(a_Alignment));
+}
+
+void CountAllocations() {
+  g_CountAllocations.store(true, std::memory_order_relaxed);
+}
+
+AllocationCounts ThreadAllocations() {
+  return g_ThreadAllocations;
+}
+
+void StageStats::Add(const StageStats& a_Other) {
+  seconds += a_Other.seconds;
+  allocations += a_Other.allocations;
+  allocatedBytes += a_Other.allocatedBytes;
+}
+
+StageTimer::StageTimer() : m_Start(std::chrono::steady_clock::now()), m_Allocations(ThreadAllocations()) {}
+
+void StageTimer::Stop(StageStats& a_Stats) {
+  auto allocations = ThreadAllocations();
+  a_Stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Start).count();
+  a_Stats.allocations += allocations.count - m_Allocations.count;
+  a_Stats.allocatedBytes += allocations.bytes - m_Allocations.bytes;
+}
+
+const char* g_StageNames[] = { "index load", "compound load", "xml parse", "extraction", "cache save", "output" };
+
+void PrintStats(const RunStats& a_Stats, bool a_AsJson) {
+  if (a_AsJson) {
+    auto stats = nlohmann::json::object();
+    auto& stages = stats["stages"] = nlohmann::json::object();
+    for (auto i = size_t{0}; i < static_cast<size_t>(Stage::Count); i++) {
+      auto name = std::string(g_StageNames[i]);
+      std::replace(name.begin(), name.end(), ' ', '_');
+      stages[name] = {
+        {"ms", a_Stats.stages[i].seconds * 1000.0},
+        {"allocations", a_Stats.stages[i].allocations},
+        {"allocated_bytes", a_Stats.stages[i].allocatedBytes}
+      };
+    }
+    stats["wall_ms"] = a_Stats.wallSeconds * 1000.0;
+    stats["bytes_read"] = a_Stats.bytesRead;
+    stats["compounds"] = a_Stats.compounds;
+    stats["compounds_extracted"] = a_Stats.compoundsExtracted;
+    stats["methods"] = a_Stats.methods;
+    stats["shards_written"] = a_Stats.shardsWritten;
+    stats["slowest"] = nlohmann::json::array();
+    for (auto& compound : a_Stats.slowest) {
+      stats["slowest"].push_back({ {"file", compound.fileName}, {"ms", compound.seconds * 1000.0} });
+    }
+
+    printf("%s\n", stats.dump().c_str());
+    return;
+  }
+
+  // The stages that run on every thread are added up over all of them, so together they can take longer than the wall time
+  printf("\n  %-14s %12s %12s %14s\n", "stage", "time (ms)", "allocations", "allocated (KB)");
+  for (auto i = size_t{0}; i < static_cast<size_t>(Stage::Count); i++) {
+    auto& stage = a_Stats.stages[i];
+    printf("  %-14s %12.2f %12llu %14.1f\n", g_StageNames[i], stage.seconds * 1000.0,
+           static_cast<unsigned long long>(stage.allocations), stage.allocatedBytes / 1024.0);
+  }
+  printf("  %-14s %12.2f\n\n", "wall", a_Stats.wallSeconds * 1000.0);
+
+  printf("  Read %.2f MB, %zu compounds of which %zu were extracted with %zu methods\n", a_Stats.bytesRead / (1024.0 * 1024.0),
+         a_Stats.compounds, a_Stats.compoundsExtracted, a_Stats.methods);
+  if (a_Stats.shardsWritten > 0) {
+    printf("  Wrote %zu shard(s)\n", a_Stats.shardsWritten);
+  }
+
+  if (!a_Stats.slowest.empty()) {
+    printf("  Slowest compounds:\n");
+    for (auto& compound : a_Stats.slowest) {
+      printf("    %8.2f ms  %s\n", compound.seconds * 1000.0, compound.fileName.c_str());
+    }
+  }
+  printf("\n");
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The stages that a run of the generator goes through, in the order that they happen
+enum class Stage {
+  IndexLoad,
+  CompoundLoad,
+  XmlParse,
+  Extraction,
+  CacheSave,
+  Output,
+  Count
+};
+
+// Amount of memory allocated through new on the calling thread since counting was turned on
+struct AllocationCounts {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+};
+
+// Starts counting the allocations of every thread, it has to be turned on before the threads start
+void CountAllocations();
+
+AllocationCounts ThreadAllocations();
+
+struct StageStats {
+  double seconds = 0.0;
+  uint64_t allocations = 0;
+  uint64_t allocatedBytes = 0;
+
+  void Add(const StageStats& a_Other);
+};
+
+// Measures the time and allocations from when it's created until Stop is called, only the allocations of
+// the thread that it was created on are counted
+class StageTimer {
+public:
+  StageTimer();
+
+  void Stop(StageStats& a_Stats);
+
+private:
+  std::chrono::steady_clock::time_point m_Start;
+  AllocationCounts m_Allocations;
+};
+
+// How long a single compound took from opening the file until it was extracted
+struct CompoundTiming {
+  std::string fileName;
+  double seconds = 0.0;
+};
+
+// Everything that was measured during a single run of the generator
+struct RunStats {
+  StageStats stages[static_cast<size_t>(Stage::Count)];
+  double wallSeconds = 0.0;
+  uint64_t bytesRead = 0;
+  size_t compounds = 0;
+  size_t compoundsExtracted = 0;
+  size_t methods = 0;
+  // Shards that had to be written again because their script bind changed
+  size_t shardsWritten = 0;
+  std::vector<CompoundTiming> slowest;
+
+  StageStats& operator[](Stage a_Stage) { return stages[static_cast<size_t>(a_Stage)]; }
+  const StageStats& operator[](Stage a_Stage) const { return stages[static_cast<size_t>(a_Stage)]; }
+};
+
+// The amount of compounds that are listed as the slowest ones
+const size_t g_SlowestCompoundCount = 5;
+
+// Prints the stats as a table or, for tools that want to keep track of them over time, as json on a single line
+void PrintStats(const RunStats& a_Stats, bool a_AsJson);
@@ -0,0 +1,38 @@
+#include "text.h"
+
+bool IsWhitespace(char a_Char) {
+  return a_Char == ' ' || a_Char == '\n' || a_Char == '\t' || a_Char == '\r';
+}
+
+void AppendNormalized(std::string_view a_Text, std::string& a_Out) {
+  auto pos = size_t{0};
+
+  while (pos < a_Text.size()) {
+    // Any amount of whitespace, line breaks included, turns into a single space but only if there is
+    // already something to separate it from
+    if (IsWhitespace(a_Text[pos])) {
+      while (pos < a_Text.size() && IsWhitespace(a_Text[pos])) {
+        pos++;
+      }
+      if (!a_Out.empty() && a_Out.back() != ' ') {
+        a_Out += ' ';
+      }
+      continue;
+    }
+
+    // Everything up until the next whitespace is copied over in one go
+    auto wordStart = pos;
+    while (pos < a_Text.size() && !IsWhitespace(a_Text[pos])) {
+      pos++;
+    }
+    a_Out.append(a_Text.data() + wordStart, pos - wordStart);
+  }
+}
+
+void TrimEnd(std::string& a_Text) {
+  auto end = a_Text.size();
+  while (end > 0 && IsWhitespace(a_Text[end - 1])) {
+    end--;
+  }
+  a_Text.resize(end);
+}
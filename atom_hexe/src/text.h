@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Spaces, tabs and line breaks, the whitespace that can show up in doxygen's xml
+bool IsWhitespace(char a_Char);
+
+// Appends a piece of doxygen text to a_Out in a single pass. Line breaks and runs of whitespace become a
+// single space, also across pieces, and no whitespace is added at the start of a_Out. That way a
+// description can be built up piece by piece straight into its final string without temporary copies
+void AppendNormalized(std::string_view a_Text, std::string& a_Out);
+
+// Removes any whitespace at the end of a string without reallocating it
+void TrimEnd(std::string& a_Text);
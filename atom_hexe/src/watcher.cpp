@@ -0,0 +1,161 @@
+#include "watcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// How long the directory has to be quiet before the changes are handed out
+const int g_SettleTimeMs = 200;
+
+// Only xml files are interesting, doxygen also writes things like .xsd and .xslt files
+void AddChangedFile(const std::string& a_FileName, std::vector<std::string>& a_ChangedFiles) {
+  if (a_FileName.size() < 4 || a_FileName.compare(a_FileName.size() - 4, 4, ".xml") != 0) {
+    return;
+  }
+  if (std::find(a_ChangedFiles.begin(), a_ChangedFiles.end(), a_FileName) == a_ChangedFiles.end()) {
+    a_ChangedFiles.push_back(a_FileName);
+  }
+}
+
+#ifdef _WIN32
+
+DirectoryWatcher::~DirectoryWatcher() {
+  if (m_DirHandle) {
+    CancelIo(m_DirHandle);
+    CloseHandle(m_DirHandle);
+  }
+  if (m_Event) {
+    CloseHandle(m_Event);
+  }
+}
+
+bool DirectoryWatcher::Open(const std::string& a_Dir) {
+  m_DirHandle = CreateFileA(a_Dir.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+  if (m_DirHandle == INVALID_HANDLE_VALUE) {
+    m_DirHandle = nullptr;
+    return false;
+  }
+
+  m_Event = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+  return m_Event != nullptr;
+}
+
+bool DirectoryWatcher::WaitForChanges(std::vector<std::string>& a_ChangedFiles, bool& a_LostTrack) {
+  // Keep reading changes until nothing has happened for a while and something has actually changed
+  while (true) {
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = m_Event;
+    ResetEvent(m_Event);
+
+    if (!ReadDirectoryChangesW(m_DirHandle, m_Buffer, sizeof(m_Buffer), FALSE,
+                               FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE, nullptr, &overlapped, nullptr)) {
+      return false;
+    }
+
+    auto timeout = a_ChangedFiles.empty() ? INFINITE : static_cast<DWORD>(g_SettleTimeMs);
+    if (WaitForSingleObject(m_Event, timeout) == WAIT_TIMEOUT) {
+      CancelIo(m_DirHandle);
+      GetOverlappedResult(m_DirHandle, &overlapped, nullptr, TRUE);
+      return true;
+    }
+
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(m_DirHandle, &overlapped, &bytes, FALSE)) {
+      return false;
+    }
+
+    // A zero sized result means the buffer overflowed, nothing else to do but check everything
+    if (bytes == 0) {
+      a_LostTrack = true;
+      AddChangedFile("index.xml", a_ChangedFiles);
+      continue;
+    }
+
+    for (auto offset = DWORD{0};;) {
+      auto info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(m_Buffer + offset);
+      auto length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, info->FileNameLength / sizeof(WCHAR), nullptr, 0, nullptr, nullptr);
+      auto fileName = std::string(length, '\0');
+      WideCharToMultiByte(CP_UTF8, 0, info->FileName, info->FileNameLength / sizeof(WCHAR), &fileName[0], length, nullptr, nullptr);
+      AddChangedFile(fileName, a_ChangedFiles);
+
+      if (info->NextEntryOffset == 0) {
+        break;
+      }
+      offset += info->NextEntryOffset;
+    }
+  }
+}
+
+#else
+
+DirectoryWatcher::~DirectoryWatcher() {
+  if (m_Fd >= 0) {
+    close(m_Fd);
+  }
+}
+
+bool DirectoryWatcher::Open(const std::string& a_Dir) {
+  m_Fd = inotify_init1(IN_CLOEXEC);
+  if (m_Fd < 0) {
+    return false;
+  }
+
+  return inotify_add_watch(m_Fd, a_Dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF) >= 0;
+}
+
+bool DirectoryWatcher::WaitForChanges(std::vector<std::string>& a_ChangedFiles, bool& a_LostTrack) {
+  // Keep reading changes until nothing has happened for a while and something has actually changed
+  while (true) {
+    pollfd pollFd{ m_Fd, POLLIN, 0 };
+    auto ready = poll(&pollFd, 1, a_ChangedFiles.empty() ? -1 : g_SettleTimeMs);
+    if (ready == 0) {
+      return true;
+    }
+    // A signal (or a debugger attaching) interrupts the wait without anything being wrong, so it's simply started again
+    if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+
+    auto bytes = read(m_Fd, m_Buffer, sizeof(m_Buffer));
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes <= 0) {
+      return false;
+    }
+
+    for (auto offset = ssize_t{0}; offset < bytes;) {
+      inotify_event event{};
+      memcpy(&event, m_Buffer + offset, sizeof(event));
+
+      // The directory was deleted, moved away or unmounted. Its watch is gone (IN_IGNORED) or about to be and
+      // nothing will be reported for it anymore, even if a directory with the same name shows up again
+      if (event.mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT)) {
+        return false;
+      }
+      // When the kernel dropped events we don't know what changed, so just check everything
+      if (event.mask & IN_Q_OVERFLOW) {
+        a_LostTrack = true;
+        AddChangedFile("index.xml", a_ChangedFiles);
+      }
+      else if (event.len > 0) {
+        AddChangedFile(m_Buffer + offset + sizeof(event), a_ChangedFiles);
+      }
+      offset += sizeof(event) + event.len;
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Watches the directory that doxygen writes its xml output to. Doxygen rewrites a lot of files in one go,
+// so changes are only reported once the directory has been quiet for a little while
+class DirectoryWatcher {
+public:
+  DirectoryWatcher() = default;
+  ~DirectoryWatcher();
+
+  DirectoryWatcher(const DirectoryWatcher&) = delete;
+  DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+  bool Open(const std::string& a_Dir);
+
+  // Blocks until one or more xml files in the directory have changed and fills a_ChangedFiles with
+  // their file names, returns false if the directory can't be watched anymore (it was deleted, moved
+  // or the watch failed), changes that were still settling are dropped then. a_LostTrack is set when
+  // there were too many changes to keep up with and every file should be checked
+  bool WaitForChanges(std::vector<std::string>& a_ChangedFiles, bool& a_LostTrack);
+
+private:
+#ifdef _WIN32
+  void* m_DirHandle = nullptr;
+  void* m_Event = nullptr;
+  alignas(4) char m_Buffer[16 * 1024];
+#else
+  int m_Fd = -1;
+  alignas(8) char m_Buffer[16 * 1024];
+#endif
+};
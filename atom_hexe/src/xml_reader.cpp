@@ -0,0 +1,337 @@
+#include "xml_reader.h"
+#include "text.h"
+
+#include <algorithm>
+#include <cstring>
+
+using tinyxml2::XMLUtil;
+
+// The entities that xml has a name for, anything else that starts with & is kept the way it's written
+struct NamedEntity {
+  std::string_view name;
+  char value;
+};
+
+constexpr NamedEntity g_NamedEntities[] = {
+  { "quot", '"' }, { "amp", '&' }, { "apos", '\'' }, { "lt", '<' }, { "gt", '>' }
+};
+
+// Decodes the entity at the start of a_Raw into a_Value, returns how much of a_Raw it took up or 0 if it isn't one
+size_t DecodeEntity(std::string_view a_Raw, char (&a_Value)[8], int& a_Length) {
+  if (a_Raw.size() < 3 || a_Raw[1] != '#') {
+    for (auto& entity : g_NamedEntities) {
+      if (a_Raw.size() > entity.name.size() + 1 && a_Raw.substr(1, entity.name.size()) == entity.name &&
+          a_Raw[entity.name.size() + 1] == ';') {
+        a_Value[0] = entity.value;
+        a_Length = 1;
+        return entity.name.size() + 2;
+      }
+    }
+    return 0;
+  }
+
+  // Character references like &#20013; or &#x4e2d; are turned into utf-8
+  auto isHex = a_Raw[2] == 'x';
+  auto digitsStart = size_t{isHex ? 3u : 2u};
+  auto semicolon = a_Raw.find(';', digitsStart);
+  if (semicolon == std::string_view::npos) {
+    return 0;
+  }
+
+  auto code = 0ul;
+  for (auto i = digitsStart; i < semicolon; i++) {
+    auto c = a_Raw[i];
+    auto digit = c >= '0' && c <= '9' ? c - '0' : -1;
+    if (isHex && digit < 0) {
+      digit = c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+    }
+    if (digit < 0) {
+      return 0;
+    }
+    code = code * (isHex ? 16 : 10) + static_cast<unsigned long>(digit);
+  }
+
+  XMLUtil::ConvertUTF32ToUTF8(code, a_Value, &a_Length);
+  return semicolon + 1;
+}
+
+void AppendPiece(std::string_view a_Piece, std::string& a_Text, bool a_Normalize) {
+  if (a_Normalize) {
+    AppendNormalized(a_Piece, a_Text);
+  }
+  else {
+    a_Text.append(a_Piece);
+  }
+}
+
+void XmlReader::AppendDecoded(std::string_view a_Raw, std::string& a_Text, bool a_Normalize, bool a_Entities) {
+  auto pieceStart = size_t{0};
+  auto pos = size_t{0};
+  auto end = a_Raw.data() + a_Raw.size();
+  // Normalizing turns line breaks into spaces anyway so they only have to be found when they are kept
+  auto specials = a_Normalize ? (a_Entities ? "&" : "") : (a_Entities ? "&\r" : "\r");
+
+  // Plain text is appended in pieces, only entities and line breaks have to be looked at one by one
+  while (pos < a_Raw.size()) {
+    pos = static_cast<size_t>(XMLUtil::FindChars(a_Raw.data() + pos, end, specials) - a_Raw.data());
+    if (pos == a_Raw.size()) {
+      break;
+    }
+
+    if (a_Raw[pos] == '&') {
+      char value[8] = {};
+      auto length = 0;
+      if (auto consumed = DecodeEntity(a_Raw.substr(pos), value, length)) {
+        AppendPiece(a_Raw.substr(pieceStart, pos - pieceStart), a_Text, a_Normalize);
+        AppendPiece(std::string_view(value, static_cast<size_t>(length)), a_Text, a_Normalize);
+        pos += consumed;
+        pieceStart = pos;
+      }
+      else {
+        pos++;
+      }
+      continue;
+    }
+
+    // Every kind of line break becomes a single \n, a \n that comes right before the \r is part of it
+    auto lineBreak = pos > pieceStart && a_Raw[pos - 1] == '\n' ? pos - 1 : pos;
+    AppendPiece(a_Raw.substr(pieceStart, lineBreak - pieceStart), a_Text, false);
+    a_Text += '\n';
+    pos += lineBreak == pos && pos + 1 < a_Raw.size() && a_Raw[pos + 1] == '\n' ? 2 : 1;
+    pieceStart = pos;
+  }
+
+  AppendPiece(a_Raw.substr(pieceStart), a_Text, a_Normalize);
+}
+
+XmlReader::XmlReader(const char* a_Data, size_t a_Size) : m_Pos(a_Data), m_End(a_Data + a_Size) {
+  SkipWhitespace();
+  if (StartsWith("\xEF\xBB\xBF")) {
+    m_Pos += 3;
+  }
+  if (m_Pos == m_End) {
+    m_Error = tinyxml2::XML_ERROR_EMPTY_DOCUMENT;
+  }
+}
+
+XmlReader::Token XmlReader::Fail(tinyxml2::XMLError a_Error) {
+  m_Error = a_Error;
+  return Token::Error;
+}
+
+void XmlReader::SkipWhitespace() {
+  // There's usually no whitespace at all, that's answered without a vectorized scan
+  if (m_Pos < m_End && XMLUtil::IsWhiteSpace(*m_Pos)) {
+    m_Pos = XMLUtil::SkipWhiteSpace(m_Pos + 1, m_End, nullptr);
+  }
+}
+
+bool XmlReader::StartsWith(std::string_view a_Prefix) const {
+  return static_cast<size_t>(m_End - m_Pos) >= a_Prefix.size() && std::string_view(m_Pos, a_Prefix.size()) == a_Prefix;
+}
+
+bool XmlReader::SkipPast(std::string_view a_Terminator, std::string_view* a_Skipped) {
+  auto rest = std::string_view(m_Pos, static_cast<size_t>(m_End - m_Pos));
+  auto found = rest.find(a_Terminator);
+  if (found == std::string_view::npos) {
+    return false;
+  }
+
+  if (a_Skipped) {
+    *a_Skipped = rest.substr(0, found);
+  }
+  m_Pos += found + a_Terminator.size();
+  return true;
+}
+
+std::string_view XmlReader::ReadName() {
+  auto start = m_Pos;
+  if (m_Pos < m_End && XMLUtil::IsNameStartChar(static_cast<unsigned char>(*m_Pos))) {
+    while (m_Pos < m_End && XMLUtil::IsNameChar(static_cast<unsigned char>(*m_Pos))) {
+      m_Pos++;
+    }
+  }
+  return std::string_view(start, static_cast<size_t>(m_Pos - start));
+}
+
+XmlReader::Token XmlReader::Next() {
+  if (m_Error != tinyxml2::XML_SUCCESS) {
+    return Token::Error;
+  }
+  if (m_Closed) {
+    return Token::EndOfDocument;
+  }
+  if (m_PendingEnd) {
+    m_PendingEnd = false;
+    return Token::EndElement;
+  }
+
+  for (;;) {
+    auto start = m_Pos;
+    SkipWhitespace();
+    if (m_Pos == m_End) {
+      // Running out of document with elements that are still open is just as broken as a mismatched end
+      return m_OpenElements.empty() ? Token::EndOfDocument : Fail(tinyxml2::XML_ERROR_PARSING);
+    }
+
+    auto isTopLevel = m_OpenElements.empty();
+    auto pastDeclarations = m_PastDeclarations;
+    m_PastDeclarations = m_PastDeclarations || !isTopLevel || !StartsWith("<?");
+
+    // Text runs until the next tag and the whitespace in front of it counts, text that is only whitespace doesn't
+    if (*m_Pos != '<') {
+      m_Pos = start;
+      auto textEnd = static_cast<const char*>(memchr(m_Pos, '<', static_cast<size_t>(m_End - m_Pos)));
+      if (!textEnd) {
+        return Fail(tinyxml2::XML_ERROR_PARSING_TEXT);
+      }
+
+      m_Text = std::string_view(m_Pos, static_cast<size_t>(textEnd - m_Pos));
+      m_TextIsCData = false;
+      m_Pos = textEnd;
+      return Token::Text;
+    }
+
+    if (StartsWith("<?")) {
+      m_Pos += 2;
+      if (!isTopLevel || pastDeclarations || !SkipPast("?>")) {
+        return Fail(tinyxml2::XML_ERROR_PARSING_DECLARATION);
+      }
+    }
+    else if (StartsWith("<!--")) {
+      m_Pos += 4;
+      if (!SkipPast("-->")) {
+        return Fail(tinyxml2::XML_ERROR_PARSING_COMMENT);
+      }
+    }
+    else if (StartsWith("<![CDATA[")) {
+      m_Pos += 9;
+      if (!SkipPast("]]>", &m_Text)) {
+        return Fail(tinyxml2::XML_ERROR_PARSING_CDATA);
+      }
+      m_TextIsCData = true;
+      return Token::Text;
+    }
+    else if (StartsWith("<!")) {
+      m_Pos += 2;
+      if (!SkipPast(">")) {
+        return Fail(tinyxml2::XML_ERROR_PARSING_UNKNOWN);
+      }
+    }
+    else {
+      m_Pos++;
+      return ReadElement();
+    }
+  }
+}
+
+XmlReader::Token XmlReader::ReadElement() {
+  auto tagStart = m_Pos - 1;
+  SkipWhitespace();
+  auto isEnd = m_Pos < m_End && *m_Pos == '/';
+  m_Pos += isEnd ? 1 : 0;
+
+  auto name = ReadName();
+  if (name.empty()) {
+    return Fail(tinyxml2::XML_ERROR_PARSING);
+  }
+
+  m_Attributes.clear();
+  for (;;) {
+    SkipWhitespace();
+    if (m_Pos == m_End) {
+      return Fail(tinyxml2::XML_ERROR_PARSING_ELEMENT);
+    }
+
+    if (XMLUtil::IsNameStartChar(static_cast<unsigned char>(*m_Pos))) {
+      auto attributeName = ReadName();
+      SkipWhitespace();
+      if (m_Pos == m_End || *m_Pos != '=') {
+        return Fail(tinyxml2::XML_ERROR_PARSING_ATTRIBUTE);
+      }
+      m_Pos++;
+      SkipWhitespace();
+      if (m_Pos == m_End || (*m_Pos != '"' && *m_Pos != '\'')) {
+        return Fail(tinyxml2::XML_ERROR_PARSING_ATTRIBUTE);
+      }
+
+      auto quote = std::string_view(m_Pos++, 1);
+      auto value = std::string_view{};
+      auto duplicate = std::find_if(m_Attributes.begin(), m_Attributes.end(), [&](const auto& a_Attribute) {
+        return a_Attribute.first == attributeName;
+      });
+      if (!SkipPast(quote, &value) || duplicate != m_Attributes.end()) {
+        return Fail(tinyxml2::XML_ERROR_PARSING_ATTRIBUTE);
+      }
+      m_Attributes.emplace_back(attributeName, value);
+    }
+    else if (*m_Pos == '>') {
+      m_Pos++;
+      break;
+    }
+    else if (StartsWith("/>") && !isEnd) {
+      m_Pos += 2;
+      m_Name = name;
+      m_PendingEnd = true;
+      return Token::StartElement;
+    }
+    else {
+      return Fail(tinyxml2::XML_ERROR_PARSING_ELEMENT);
+    }
+  }
+
+  m_Name = name;
+  if (!isEnd) {
+    m_OpenElements.push_back(name);
+    return Token::StartElement;
+  }
+
+  // tinyxml2 stops reading when the document itself is closed, whatever comes after it is ignored
+  if (m_OpenElements.empty()) {
+    m_Pos = tagStart;
+    m_Closed = true;
+    return Token::EndOfDocument;
+  }
+  if (m_OpenElements.back() != name) {
+    return Fail(tinyxml2::XML_ERROR_MISMATCHED_ELEMENT);
+  }
+  m_OpenElements.pop_back();
+  return Token::EndElement;
+}
+
+bool XmlReader::NextChild() {
+  auto token = Next();
+  while (token == Token::Text) {
+    token = Next();
+  }
+  return token == Token::StartElement;
+}
+
+void XmlReader::SkipElement() {
+  for (auto depth = 1; depth > 0;) {
+    auto token = Next();
+    if (token == Token::StartElement) {
+      depth++;
+    }
+    else if (token == Token::EndElement) {
+      depth--;
+    }
+    else if (token != Token::Text) {
+      return;
+    }
+  }
+}
+
+bool XmlReader::FindAttribute(std::string_view a_Name, std::string_view& a_Value) const {
+  for (auto& attribute : m_Attributes) {
+    if (attribute.first == a_Name) {
+      a_Value = attribute.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+void XmlReader::AppendText(std::string& a_Text, bool a_Normalize) const {
+  AppendDecoded(m_Text, a_Text, a_Normalize, !m_TextIsCData);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "tinyxml2/tinyxml2.h"
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Reads an xml document one token at a time instead of building a tree out of it. The caller asks for the next
+// token and decides what to do with it, so nothing but the elements that are still open has to be remembered.
+// Names and text point straight into the buffer, text is only decoded when it's appended somewhere. It follows
+// the same rules as tinyxml2: whitespace between elements is skipped, entities and line breaks are decoded
+// the same way and a document that tinyxml2 wouldn't load fails with the same kind of error
+class XmlReader {
+public:
+  enum class Token {
+    StartElement,
+    EndElement,
+    Text,
+    EndOfDocument,
+    Error
+  };
+
+  XmlReader(const char* a_Data, size_t a_Size);
+
+  Token Next();
+
+  // Moves on to the next child of the element that was started last, text in between is skipped. Returns false
+  // once the element has ended (or the document is broken), every child has to be read or skipped before this
+  // is called again
+  bool NextChild();
+
+  // Skips the rest of the element that was started last, its end included
+  void SkipElement();
+
+  // Name of the element that was started or ended last
+  std::string_view Name() const { return m_Name; }
+
+  // Whether the element that was started last closed itself (<name/>), its end is then the very next token
+  bool IsSelfClosing() const { return m_PendingEnd; }
+
+  // The raw value of an attribute of the element that was started last, entities haven't been decoded yet
+  bool FindAttribute(std::string_view a_Name, std::string_view& a_Value) const;
+
+  // Decodes the text that was read last onto the end of a_Text, normalized like AppendNormalized if asked for
+  void AppendText(std::string& a_Text, bool a_Normalize = false) const;
+
+  tinyxml2::XMLError Error() const { return m_Error; }
+
+  // How far the reader got, everything in front of this has been read. A close tag for an element that was
+  // never started ends the document like it does in tinyxml2, the reader stops in front of it
+  const char* Position() const { return m_Pos; }
+
+  // Decodes the entities and line breaks in a bit of raw text or an attribute value onto the end of a_Text
+  static void AppendDecoded(std::string_view a_Raw, std::string& a_Text, bool a_Normalize = false, bool a_Entities = true);
+
+private:
+  Token Fail(tinyxml2::XMLError a_Error);
+  Token ReadElement();
+  void SkipWhitespace();
+  bool StartsWith(std::string_view a_Prefix) const;
+  // Moves past the next a_Terminator, returns false if there isn't one
+  bool SkipPast(std::string_view a_Terminator, std::string_view* a_Skipped = nullptr);
+  std::string_view ReadName();
+
+  const char* m_Pos;
+  const char* m_End;
+  std::string_view m_Name;
+  std::string_view m_Text;
+  bool m_TextIsCData = false;
+  // Self closing elements are started and ended by two separate tokens
+  bool m_PendingEnd = false;
+  // Declarations are only allowed before anything else in the document
+  bool m_PastDeclarations = false;
+  bool m_Closed = false;
+  std::vector<std::pair<std::string_view, std::string_view>> m_Attributes;
+  std::vector<std::string_view> m_OpenElements;
+  tinyxml2::XMLError m_Error = tinyxml2::XML_SUCCESS;
+};